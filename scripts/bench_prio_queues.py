@@ -0,0 +1,88 @@
+import os
+import time
+import shlex
+import subprocess
+import statistics
+
+BASE_DIRECTORY = 'graphs'
+RESULTS_DIRECTORY = os.path.join('benches', 'prio-queues')
+REPETITIONS = 5
+TIMEOUT = 300 # 5 minutes
+
+# Executable per priority queue variant (see PRIO_QUEUE in the Makefile)
+VARIANTS = {
+    'indexed': 'min-cost-ST-indexed',
+    'lazy': 'min-cost-ST-lazy',
+}
+
+# Modes whose running time is dominated by Dijkstra or Prim
+OPTIONS = {
+    'mst': '-m -c',
+    'tm': '-h -c',
+    'two-apx': '-a -c',
+}
+
+
+def build_variants():
+    for variant, executable in VARIANTS.items():
+        print(f'=== Building {executable}')
+        subprocess.run(
+            ['make', f'PRIO_QUEUE={variant}', f'OBJ_DIR=obj-{variant}', f'EXEC={executable}'],
+            check=True
+        )
+
+
+def time_run(executable, option, file_path):
+    # Returns the median running time in ms or None if a run fails
+    times_ms = []
+    for _ in range(REPETITIONS):
+        start_time = time.perf_counter()
+        try:
+            process = subprocess.run(
+                [f'./{executable}'] + shlex.split(option) + [file_path],
+                stdout=subprocess.DEVNULL,
+                stderr=subprocess.DEVNULL,
+                timeout=TIMEOUT
+            )
+        except subprocess.TimeoutExpired:
+            return None
+        if process.returncode != 0:
+            return None
+        times_ms.append((time.perf_counter() - start_time) * 1000.0)
+    return statistics.median(times_ms)
+
+
+def benchmark_track(track_directory):
+    track_name = os.path.basename(track_directory)
+    os.makedirs(RESULTS_DIRECTORY, exist_ok=True)
+
+    for log_name, option in OPTIONS.items():
+        log_file_path = os.path.join(RESULTS_DIRECTORY, f'{track_name}-{log_name}.log')
+        print(f'=== Running {option} on {track_name}')
+
+        with open(log_file_path, 'w') as lf:
+            for file_name in sorted(os.listdir(track_directory)):
+                if not file_name.endswith('.gr'):
+                    continue
+                file_path = os.path.join(track_directory, file_name)
+
+                results = {variant: time_run(executable, option, file_path) for variant, executable in VARIANTS.items()}
+                if any(t is None for t in results.values()):
+                    lf.write(f'{file_name}: -\n')
+                    continue
+
+                times = ', '.join(f'{variant}: {t:.2f} ms' for variant, t in results.items())
+                speedup = results['lazy'] / results['indexed'] if results['indexed'] > 0 else 0.0
+                lf.write(f'{file_name}: {times}, speedup: {speedup:.2f}\n')
+
+
+def main():
+    build_variants()
+    for sub_directory in sorted(os.listdir(BASE_DIRECTORY)):
+        full_sub_directory_path = os.path.join(BASE_DIRECTORY, sub_directory)
+        if os.path.isdir(full_sub_directory_path):
+            benchmark_track(full_sub_directory_path)
+
+
+if __name__ == '__main__':
+    main()
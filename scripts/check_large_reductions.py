@@ -0,0 +1,76 @@
+import os
+import sys
+import json
+import time
+import random
+import shlex
+import tempfile
+import subprocess
+
+EXECUTABLE = 'min-cost-ST'
+TIMEOUT = 300 # 5 minutes
+SEED = 1
+
+# Sparse random graph of the size where unbounded long edge searches did not finish
+N_VERTICES = 300000
+N_EDGES = 1100000
+N_TERMINALS = 1000
+
+OPTIONS = ['-h -r', '-a -r', '-m -r']
+
+
+def write_random_graph(file_path):
+    # Random spanning tree plus random edges, integer costs in [1, 100]
+    rng = random.Random(SEED)
+    edges = [(v, rng.randint(1, v - 1)) for v in range(2, N_VERTICES + 1)]
+    while len(edges) < N_EDGES:
+        v, w = rng.sample(range(1, N_VERTICES + 1), 2)
+        edges.append((v, w))
+    terminals = rng.sample(range(1, N_VERTICES + 1), N_TERMINALS)
+
+    with open(file_path, 'w') as f:
+        f.write(f'SECTION Graph\nNodes {N_VERTICES}\nEdges {len(edges)}\n')
+        for v, w in edges:
+            f.write(f'E {v} {w} {rng.randint(1, 100)}\n')
+        f.write(f'END\n\nSECTION Terminals\nTerminals {N_TERMINALS}\n')
+        for t in terminals:
+            f.write(f'T {t}\n')
+        f.write('END\n\nEOF\n')
+
+
+def check_option(option, file_path):
+    # Returns whether the run finished in time with a valid tree
+    start_time = time.perf_counter()
+    try:
+        process = subprocess.run(
+            [f'./{EXECUTABLE}'] + shlex.split(option) + ['-c', '-t', '-i', file_path],
+            capture_output=True,
+            text=True,
+            timeout=TIMEOUT
+        )
+    except subprocess.TimeoutExpired:
+        print(f'{option}: no result within {TIMEOUT} s')
+        return False
+    seconds = time.perf_counter() - start_time
+    if process.returncode != 0:
+        print(f'{option}: failed with exit code {process.returncode}')
+        return False
+
+    stats = json.loads(process.stderr.strip().splitlines()[-1])
+    cost = process.stdout.strip().splitlines()[0]
+    print(f'{option}: {cost}, {seconds:.2f} s in total, {stats["phases"]["reduce"]["seconds"]:.2f} s reducing, '
+          f'{stats["counters"]["reduced_edges"]} edges removed')
+    return True
+
+
+def main():
+    with tempfile.TemporaryDirectory() as directory:
+        file_path = os.path.join(directory, 'random.gr')
+        print(f'=== Writing random graph with {N_VERTICES} vertices and {N_EDGES} edges')
+        write_random_graph(file_path)
+        results = [check_option(option, file_path) for option in OPTIONS]
+    sys.exit(0 if all(results) else 1)
+
+
+if __name__ == '__main__':
+    main()
@@ -10,6 +10,7 @@ MAX_TOTAL_TIME_MS = 50_000 # 50 seconds
 MIN_REPETITIONS = 0
 MAX_REPETITIONS = 1000
 TIMEOUT = 300 # 5 minutes
+USE_GRAPH_CACHE = True # Measure runs on the binary graph cache instead of parsing the .gr file
 
 def parse_mem(stderr_text):
     mem_kb = 0
@@ -79,12 +80,20 @@ def run_bench(option, file_path):
         return (None, None, None)
 
 
+def create_graph_cache(file_path):
+    # Any mode works, the cache is written right after parsing
+    subprocess.run(['./min-cost-ST', '-m', '-c', '-w', file_path], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
 def benchmark_file(option, sub_directory, log_file):
     for file_name in os.listdir(sub_directory):
         file_path = os.path.join(sub_directory, file_name)
-        if not os.path.isfile(file_path):
+        if not os.path.isfile(file_path) or not file_name.endswith('.gr'):
             continue
 
+        if USE_GRAPH_CACHE and not os.path.isfile(file_path + '.cache'):
+            create_graph_cache(file_path)
+
         # Initial run
         print(f'Processing {file_path} {option}...')
         first_time_ms, first_mem_kb, cost = run_bench(option, file_path)
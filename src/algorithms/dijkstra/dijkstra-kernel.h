@@ -0,0 +1,85 @@
+// Search loop of limitedMultiDijkstra, included by dijkstra.c once per cost type, distance type and queue.
+// Expects KERNEL_NAME, COST_TYPE and COSTS (cost array of the adjacency), DIST_TYPE, DIST (distance array
+// of PathsData) and DIST_INF (its value for unreached vertices), QUEUE (member of SearchQueue), QUEUE_VALUE
+// and the queue operations PUSH, POP and IS_EMPTY. No include guard on purpose.
+
+static void KERNEL_NAME(int *sources, const double *sourceDists, int nSources, SearchLimits limits, PathsData *pathsData, Graph *g) {
+	const COST_TYPE *costs = g->COSTS;
+	DIST_TYPE *dist = pathsData->DIST;
+	int nSettledMarked = 0;
+	long nPushes = nSources;
+	long nPops = 0;
+	long nRelaxed = 0;
+
+	for (int i = 0; i < nSources; i++) {
+		int s = sources[i];
+		DIST_TYPE sourceDist = (sourceDists != NULL) ? (DIST_TYPE)sourceDists[i] : 0;
+		if (dist[s] == DIST_INF) {
+			pathsData->touched[pathsData->nTouched] = s; // First time reached since last clean
+			pathsData->nTouched++;
+		}
+		dist[s] = sourceDist;
+		pathsData->preEdgeIndices[s] = -1; // Source may have been reached by a previous search
+		PUSH(s, sourceDist, pathsData->pq->QUEUE);
+	}
+
+	while (!IS_EMPTY(pathsData->pq->QUEUE)) {
+		QUEUE_VALUE value;
+		int v = POP(pathsData->pq->QUEUE, &value);
+		nPops++;
+
+		if (value != dist[v]) {
+			continue; // Skip old entry
+		}
+		DIST_TYPE vDist = dist[v];
+		if (vDist > limits.maxDist) {
+			break; // All remaining vertices are beyond the bound
+		}
+		if (v == limits.target) {
+			break;
+		}
+		if (limits.isMarked != NULL && limits.isMarked[v]) {
+			nSettledMarked++;
+			if (nSettledMarked == limits.nMarked) {
+				break;
+			}
+		}
+
+		int degree = g->offsets[v+1] - g->offsets[v];
+		if (limits.maxScannedEdges >= 0 && nRelaxed + degree > limits.maxScannedEdges) {
+			break; // Distances found so far still belong to paths of the graph
+		}
+		nRelaxed += degree;
+		for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+			int w = g->adjVertices[i];
+			DIST_TYPE newDist = vDist + (DIST_TYPE)costs[i];
+
+			if (dist[w] > newDist && newDist <= limits.maxDist) {
+				if (dist[w] == DIST_INF) {
+					pathsData->touched[pathsData->nTouched] = w;
+					pathsData->nTouched++;
+				}
+				dist[w] = newDist;
+				pathsData->preEdgeIndices[w] = g->adjEdges[i];
+				PUSH(w, newDist, pathsData->pq->QUEUE);
+				nPushes++;
+			}
+			else if (dist[w] == newDist && costs[i] > 0 && g->adjEdges[i] < pathsData->preEdgeIndices[w]) {
+				pathsData->preEdgeIndices[w] = g->adjEdges[i]; // Equal paths end with the lowest edge index, whatever the order of the search
+			}
+		}
+	}
+	countSearch(true, nPushes, nPops, nRelaxed);
+}
+
+#undef KERNEL_NAME
+#undef COST_TYPE
+#undef COSTS
+#undef DIST_TYPE
+#undef DIST
+#undef DIST_INF
+#undef QUEUE
+#undef QUEUE_VALUE
+#undef PUSH
+#undef POP
+#undef IS_EMPTY
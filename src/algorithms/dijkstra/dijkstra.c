@@ -1,39 +1,127 @@
 #include <stdlib.h>
 #include <float.h>
+#include <limits.h>
 
 #include "dijkstra.h"
-#include "../../structures/prio-queue.h"
 #include "../../structures/graph.h"
+#include "../../stats.h"
 
 PathsData *createPathsData(int n) {
 	PathsData *pathsData = calloc(1, sizeof(PathsData));
-	pathsData->dist = calloc(n, sizeof(double));
+	pathsData->n = n;
+	pathsData->distType = REAL_DISTS; // Distance arrays are allocated by the first search
 	pathsData->preEdgeIndices = calloc(n, sizeof(int));
+	pathsData->touched = calloc(n, sizeof(int));
+	pathsData->nTouched = 0;
+	pathsData->pq = createSearchQueue(n);
 
 	for (int i = 0; i < n; i++) {
-		pathsData->dist[i] = DBL_MAX;
 		pathsData->preEdgeIndices[i] = -1;
 	}
 	return pathsData;
 }
 
-void cleanPathsData(PathsData *pathsData, int n) {
-	for (int i = 0; i < n; i++) {
-		pathsData->preEdgeIndices[i] = -1;
-		pathsData->dist[i] = DBL_MAX;
+// Sets the touched distances of the current type back to unreached
+static void clearDists(PathsData *pathsData) {
+	for (int i = 0; i < pathsData->nTouched; i++) {
+		int v = pathsData->touched[i];
+		switch (pathsData->distType) {
+			case INT32_DISTS:
+				pathsData->intDist[v] = INT_MAX;
+				break;
+			case INT64_DISTS:
+				pathsData->longDist[v] = LLONG_MAX;
+				break;
+			default:
+				pathsData->dist[v] = DBL_MAX;
+		}
+	}
+}
+
+void cleanPathsData(PathsData *pathsData) {
+	clearDists(pathsData);
+	for (int i = 0; i < pathsData->nTouched; i++) {
+		pathsData->preEdgeIndices[pathsData->touched[i]] = -1;
 	}
+	pathsData->nTouched = 0;
+	clearSearchQueue(pathsData->pq);
 }
 
 void freePathsData(PathsData *pathsData) {
 	free(pathsData->dist);
+	free(pathsData->longDist);
+	free(pathsData->intDist);
 	free(pathsData->preEdgeIndices);
+	free(pathsData->touched);
+	freeSearchQueue(pathsData->pq);
 	free(pathsData);
 }
 
+// Narrowest distance type for a search on g, whose sources start at most at maxSourceDist
+static DistType selectDistType(double maxSourceDist, PathsData *pathsData, Graph *g) {
+	if (g->costType == REAL_COSTS) {
+		return REAL_DISTS;
+	}
+	// Every relaxed path has at most n edges
+	bool fitsInt = g->costType == INT32_COSTS && maxSourceDist + g->maxCost * g->n < INT_MAX;
+	// An extended search keeps the distances of the previous ones unless they have to be widened
+	if (fitsInt && (pathsData->nTouched == 0 || pathsData->distType == INT32_DISTS)) {
+		return INT32_DISTS;
+	}
+	return INT64_DISTS;
+}
+
+// Allocates the distances of type on first use and moves the touched distances over to it
+static void prepareDists(DistType type, PathsData *pathsData) {
+	int n = pathsData->n;
+	if (type == INT32_DISTS && pathsData->intDist == NULL) {
+		pathsData->intDist = calloc(n, sizeof(int));
+		for (int i = 0; i < n; i++) {
+			pathsData->intDist[i] = INT_MAX;
+		}
+	}
+	else if (type == INT64_DISTS && pathsData->longDist == NULL) {
+		pathsData->longDist = calloc(n, sizeof(long long));
+		for (int i = 0; i < n; i++) {
+			pathsData->longDist[i] = LLONG_MAX;
+		}
+	}
+	else if (type == REAL_DISTS && pathsData->dist == NULL) {
+		pathsData->dist = calloc(n, sizeof(double));
+		for (int i = 0; i < n; i++) {
+			pathsData->dist[i] = DBL_MAX;
+		}
+	}
+	if (type == pathsData->distType) {
+		return;
+	}
+
+	double *moved = calloc(pathsData->nTouched + 1, sizeof(double));
+	for (int i = 0; i < pathsData->nTouched; i++) {
+		moved[i] = getDist(pathsData->touched[i], pathsData); // Touched vertices are reached
+	}
+	clearDists(pathsData);
+	pathsData->distType = type;
+	for (int i = 0; i < pathsData->nTouched; i++) {
+		int v = pathsData->touched[i];
+		switch (type) {
+			case INT32_DISTS:
+				pathsData->intDist[v] = (int)moved[i];
+				break;
+			case INT64_DISTS:
+				pathsData->longDist[v] = (long long)moved[i];
+				break;
+			default:
+				pathsData->dist[v] = moved[i];
+		}
+	}
+	free(moved);
+}
+
 void printPathsData(PathsData *pd, int n, Graph *g) {
 	printf("\ndist: ");
 	for (int v = 0; v < n; v++) {
-		printf("%.2lf; ", pd->dist[v]);
+		printf("%.2lf; ", getDist(v, pd));
 	}
 	printf("\npre-edges: ");
 	printEdgeIndices(pd->preEdgeIndices, n, g);
@@ -54,38 +142,242 @@ void freeMultiPathsDatas(PathsData **pathsDatas, int nPaths) {
 	free(pathsDatas);
 }
 
-void multiDijkstra(int *sources, int nSources, PathsData *pathsData, Graph *g) {
-	PrioQueue *pq = createPrioQueue(g->n);
+SearchLimits noSearchLimits(void) {
+	return (SearchLimits){DBL_MAX, -1, NULL, 0, -1};
+}
 
-	for (int i = 0; i < nSources; i++) {
-		int s = sources[i];
-		pathsData->dist[s] = 0;
-		insert((Pair){s, 0}, pq);
-	}
+// Kernels per cost type, distance type and queue. The queue is chosen by prepareSearchQueue from the costs
+// of the graph, the distance type by selectDistType.
+
+#define KERNEL_NAME searchInt32Buckets
+#define COST_TYPE int
+#define COSTS adjIntCosts
+#define DIST_TYPE int
+#define DIST intDist
+#define DIST_INF INT_MAX
+#define QUEUE buckets
+#define QUEUE_VALUE unsigned long long
+#define PUSH pushBucketQueue
+#define POP extractMinBucketQueue
+#define IS_EMPTY isEmptyBucketQueue
+#include "dijkstra-kernel.h"
+
+#define KERNEL_NAME searchInt32Radix
+#define COST_TYPE int
+#define COSTS adjIntCosts
+#define DIST_TYPE int
+#define DIST intDist
+#define DIST_INF INT_MAX
+#define QUEUE radix
+#define QUEUE_VALUE unsigned long long
+#define PUSH pushRadixHeap
+#define POP extractMinRadixHeap
+#define IS_EMPTY isEmptyRadixHeap
+#include "dijkstra-kernel.h"
+
+#define KERNEL_NAME searchInt32Heap
+#define COST_TYPE int
+#define COSTS adjIntCosts
+#define DIST_TYPE int
+#define DIST intDist
+#define DIST_INF INT_MAX
+#define QUEUE heap
+#define QUEUE_VALUE double
+#define PUSH pushHeapQueue
+#define POP popHeapQueue
+#define IS_EMPTY isEmptyHeapQueue
+#include "dijkstra-kernel.h"
+
+#define KERNEL_NAME searchInt64Buckets
+#define COST_TYPE int
+#define COSTS adjIntCosts
+#define DIST_TYPE long long
+#define DIST longDist
+#define DIST_INF LLONG_MAX
+#define QUEUE buckets
+#define QUEUE_VALUE unsigned long long
+#define PUSH pushBucketQueue
+#define POP extractMinBucketQueue
+#define IS_EMPTY isEmptyBucketQueue
+#include "dijkstra-kernel.h"
+
+#define KERNEL_NAME searchInt64Radix
+#define COST_TYPE int
+#define COSTS adjIntCosts
+#define DIST_TYPE long long
+#define DIST longDist
+#define DIST_INF LLONG_MAX
+#define QUEUE radix
+#define QUEUE_VALUE unsigned long long
+#define PUSH pushRadixHeap
+#define POP extractMinRadixHeap
+#define IS_EMPTY isEmptyRadixHeap
+#include "dijkstra-kernel.h"
+
+#define KERNEL_NAME searchInt64Heap
+#define COST_TYPE int
+#define COSTS adjIntCosts
+#define DIST_TYPE long long
+#define DIST longDist
+#define DIST_INF LLONG_MAX
+#define QUEUE heap
+#define QUEUE_VALUE double
+#define PUSH pushHeapQueue
+#define POP popHeapQueue
+#define IS_EMPTY isEmptyHeapQueue
+#include "dijkstra-kernel.h"
 
-	while (!isEmpty(pq)) {
-		Pair v = extractMin(pq);
+// Integer costs beyond INT_MAX stay double in the adjacency, their distances are exact as int64
 
-		if (v.value != pathsData->dist[v.key]) {
-			continue; // Skip old entry
+#define KERNEL_NAME searchLargeRadix
+#define COST_TYPE double
+#define COSTS adjCosts
+#define DIST_TYPE long long
+#define DIST longDist
+#define DIST_INF LLONG_MAX
+#define QUEUE radix
+#define QUEUE_VALUE unsigned long long
+#define PUSH pushRadixHeap
+#define POP extractMinRadixHeap
+#define IS_EMPTY isEmptyRadixHeap
+#include "dijkstra-kernel.h"
+
+#define KERNEL_NAME searchLargeHeap
+#define COST_TYPE double
+#define COSTS adjCosts
+#define DIST_TYPE long long
+#define DIST longDist
+#define DIST_INF LLONG_MAX
+#define QUEUE heap
+#define QUEUE_VALUE double
+#define PUSH pushHeapQueue
+#define POP popHeapQueue
+#define IS_EMPTY isEmptyHeapQueue
+#include "dijkstra-kernel.h"
+
+#define KERNEL_NAME searchRealHeap
+#define COST_TYPE double
+#define COSTS adjCosts
+#define DIST_TYPE double
+#define DIST dist
+#define DIST_INF DBL_MAX
+#define QUEUE heap
+#define QUEUE_VALUE double
+#define PUSH pushHeapQueue
+#define POP popHeapQueue
+#define IS_EMPTY isEmptyHeapQueue
+#include "dijkstra-kernel.h"
+
+static void search(int *sources, const double *sourceDists, int nSources, SearchLimits limits, PathsData *pathsData, Graph *g) {
+	// A source below the first one would rebuild the radix heap around it, the heap is used for those
+	bool isMonotone = true;
+	double maxSourceDist = 0;
+	for (int i = 0; sourceDists != NULL && i < nSources; i++) {
+		isMonotone &= sourceDists[i] >= sourceDists[0];
+		if (sourceDists[i] > maxSourceDist) {
+			maxSourceDist = sourceDists[i];
 		}
+	}
+	DistType distType = selectDistType(maxSourceDist, pathsData, g);
+	prepareDists(distType, pathsData);
+	prepareSearchQueue(pathsData->pq, g, isMonotone);
+	QueueKind kind = pathsData->pq->kind;
 
-		for (int i = 0; i < g->vertices[v.key].deg; i++) {
-			Edge *e = getEdge(v.key, i, g);
-
-			int w = getPredecessor(v.key, *e);
-			double newDist = pathsData->dist[v.key] + e->cost;
-			
-			if (pathsData->dist[w] > newDist) {
-				pathsData->dist[w] = newDist;
-				pathsData->preEdgeIndices[w] = getEdgeIndex(v.key, i, g);
-				insert((Pair){w, newDist}, pq);
-			}
+	if (g->costType == REAL_COSTS) { // Only with the heap
+		searchRealHeap(sources, sourceDists, nSources, limits, pathsData, g);
+	}
+	else if (g->costType == INTEGER_COSTS) { // Costs beyond the bucket queue
+		if (kind == RADIX_QUEUE) {
+			searchLargeRadix(sources, sourceDists, nSources, limits, pathsData, g);
+		}
+		else {
+			searchLargeHeap(sources, sourceDists, nSources, limits, pathsData, g);
+		}
+	}
+	else if (distType == INT32_DISTS) {
+		switch (kind) {
+			case BUCKET_QUEUE:
+				searchInt32Buckets(sources, sourceDists, nSources, limits, pathsData, g);
+				break;
+			case RADIX_QUEUE:
+				searchInt32Radix(sources, sourceDists, nSources, limits, pathsData, g);
+				break;
+			default:
+				searchInt32Heap(sources, sourceDists, nSources, limits, pathsData, g);
 		}
 	}
-	freePrioQueue(pq);
+	else {
+		switch (kind) {
+			case BUCKET_QUEUE:
+				searchInt64Buckets(sources, sourceDists, nSources, limits, pathsData, g);
+				break;
+			case RADIX_QUEUE:
+				searchInt64Radix(sources, sourceDists, nSources, limits, pathsData, g);
+				break;
+			default:
+				searchInt64Heap(sources, sourceDists, nSources, limits, pathsData, g);
+		}
+	}
+}
+
+void limitedMultiDijkstra(int *sources, int nSources, SearchLimits limits, PathsData *pathsData, Graph *g) {
+	search(sources, NULL, nSources, limits, pathsData, g);
+}
+
+void seededMultiDijkstra(int *sources, double *sourceDists, int nSources, SearchLimits limits, PathsData *pathsData, Graph *g) {
+	search(sources, sourceDists, nSources, limits, pathsData, g);
+}
+
+void multiDijkstra(int *sources, int nSources, PathsData *pathsData, Graph *g) {
+	limitedMultiDijkstra(sources, nSources, noSearchLimits(), pathsData, g);
 }
 
 void dijkstra(int s, PathsData *pathsData, Graph *g) {
 	multiDijkstra(&s, 1, pathsData, g);
 }
+
+void boundedDijkstra(int s, double maxDist, PathsData *pathsData, Graph *g) {
+	SearchLimits limits = noSearchLimits();
+	limits.maxDist = maxDist;
+	limitedMultiDijkstra(&s, 1, limits, pathsData, g);
+}
+
+void dijkstraToTarget(int s, int target, PathsData *pathsData, Graph *g) {
+	SearchLimits limits = noSearchLimits();
+	limits.target = target;
+	limitedMultiDijkstra(&s, 1, limits, pathsData, g);
+}
+
+void dijkstraUntilSettled(int *sources, int nSources, bool *isMarked, int nMarked, PathsData *pathsData, Graph *g) {
+	SearchLimits limits = noSearchLimits();
+	limits.isMarked = isMarked;
+	limits.nMarked = nMarked;
+	limitedMultiDijkstra(sources, nSources, limits, pathsData, g);
+}
+
+// Source of the shortest path to every vertex after a multi-source search (-1 if unreachable)
+int *findNearestSources(PathsData *pathsData, Graph *g) {
+	int *sources = calloc(g->n, sizeof(int));
+	for (int v = 0; v < g->n; v++) {
+		sources[v] = -2; // Not determined yet
+	}
+	for (int v = 0; v < g->n; v++) {
+		// Follow the predecessors up to a vertex with known source or a root of the shortest path forest
+		int u = v;
+		while (sources[u] == -2 && pathsData->preEdgeIndices[u] != -1) {
+			u = getPredecessor(u, g->edges[pathsData->preEdgeIndices[u]]);
+		}
+		if (sources[u] == -2) {
+			sources[u] = (getDist(u, pathsData) == DBL_MAX) ? -1 : u;
+		}
+		int source = sources[u];
+
+		// Assign the source to the whole followed path
+		u = v;
+		while (sources[u] == -2) {
+			sources[u] = source;
+			u = getPredecessor(u, g->edges[pathsData->preEdgeIndices[u]]);
+		}
+	}
+	return sources;
+}
@@ -1,22 +1,71 @@
 #ifndef DIJKSTRA_H
 #define DIJKSTRA_H
 
+#include <limits.h>
+#include <float.h>
+
 #include "../../structures/graph.h"
+#include "../../structures/search-queue.h"
 #include "../../utils.h"
 
+// Reusable workspace of shortest path searches.
+// Vertices whose distance was set since the last clean are recorded in touched,
+// so cleaning only costs what the previous searches reached.
+// Without cleaning, a completed search can be extended by further sources: only vertices
+// that get closer to the new sources are relaxed again.
+// Of equally short paths, the one whose last edge has the lowest index is kept (for positive costs), so a completed
+// search that is extended has the same distances and predecessors as one search from all sources.
+// Distances are stored in the narrowest type that holds every distance of the search, chosen per search
+// from the cost type of the graph (arrays are allocated on first use). Read them with getDist.
+typedef enum {
+	REAL_DISTS,
+	INT64_DISTS,
+	INT32_DISTS // Integer costs whose longest possible distance stays below INT_MAX
+} DistType;
+
 typedef struct {
+	int n;
+	DistType distType;
 	double *dist;
+	long long *longDist;
+	int *intDist;
 	int *preEdgeIndices;
+	int *touched;
+	int nTouched;
+	SearchQueue *pq;
 } PathsData;
 
+// Early termination criteria of a search. Only settled vertices have their final distance afterwards.
+typedef struct {
+	double maxDist; // Stop once the next vertex to settle is farther away (DBL_MAX for no bound)
+	int target; // Stop once target is settled (-1 for no target)
+	bool *isMarked; // Stop once nMarked of the marked vertices are settled (NULL for no marked set)
+	int nMarked;
+	long maxScannedEdges; // Stop before the next vertex would scan its edges beyond this many in total (-1 for no limit)
+} SearchLimits;
+
+SearchLimits noSearchLimits(void);
+
 PathsData *createPathsData(int n);
 
-void cleanPathsData(PathsData *data, int n);
+void cleanPathsData(PathsData *data);
 
 void freePathsData(PathsData *data);
 
 void printPathsData(PathsData *pd, int n, Graph *g);
 
+// Distance of v found by the last searches, DBL_MAX if not reached
+static inline double getDist(int v, PathsData *pd) {
+	switch (pd->distType) {
+		case INT32_DISTS:
+			return pd->intDist[v] == INT_MAX ? DBL_MAX : pd->intDist[v];
+		case INT64_DISTS:
+			return pd->longDist[v] == LLONG_MAX ? DBL_MAX : pd->longDist[v];
+		default:
+			return pd->dist[v];
+	}
+}
+
 PathsData **createMultiPathDatas(int nPaths, int pathLen);
 
 void freeMultiPathsDatas(PathsData **pathsDatas, int nPaths);
@@ -25,4 +74,19 @@ void multiDijkstra(int *sources, int nSources, PathsData *pathsData, Graph *g);
 
 void dijkstra(int s, PathsData *pathsData, Graph *g);
 
+void limitedMultiDijkstra(int *sources, int nSources, SearchLimits limits, PathsData *pathsData, Graph *g);
+
+// Sources start at the given distances instead of 0, with integer costs the distances have to be integral.
+// The first source should have the smallest distance, otherwise large integer costs are searched with the heap
+// instead of the radix heap.
+void seededMultiDijkstra(int *sources, double *sourceDists, int nSources, SearchLimits limits, PathsData *pathsData, Graph *g);
+
+void boundedDijkstra(int s, double maxDist, PathsData *pathsData, Graph *g);
+
+void dijkstraToTarget(int s, int target, PathsData *pathsData, Graph *g);
+
+void dijkstraUntilSettled(int *sources, int nSources, bool *isMarked, int nMarked, PathsData *pathsData, Graph *g);
+
+int *findNearestSources(PathsData *pathsData, Graph *g);
+
 #endif
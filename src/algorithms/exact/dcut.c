@@ -0,0 +1,260 @@
+#include <glpk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "../max-flow/max-flow.h"
+#include "dcut.h"
+#include "warm-start.h"
+#include "../../stats.h"
+
+#define CUT_EPS 1e-6 // Cuts are only added if the LP solution violates them by more than this
+#define MAX_NESTED_CUTS 10 // Cuts per terminal and separation round
+
+typedef struct {
+	Graph *arcs;
+	int root;
+	int *targets; // Distinct terminals other than root
+	int nTargets;
+	MaxFlow *mf;
+	double *capacities;
+	int *rowInds; // Scratch row for glp_set_mat_row (1-indexed)
+	double *rowVals;
+	int nCuts;
+	WarmStart *ws; // NULL without warm start
+} CutSeparator;
+
+static CutSeparator createCutSeparator(Graph *arcs, Terminals *terms) {
+	CutSeparator sep;
+	sep.arcs = arcs;
+	sep.root = terms->vertices[0];
+	sep.targets = calloc(terms->n, sizeof(int));
+	sep.nTargets = 0;
+	bool *isTarget = calloc(arcs->n, sizeof(bool));
+	for (int i = 1; i < terms->n; i++) {
+		int t = terms->vertices[i];
+		if (t != sep.root && !isTarget[t]) {
+			isTarget[t] = true;
+			sep.targets[sep.nTargets] = t;
+			sep.nTargets++;
+		}
+	}
+	free(isTarget);
+	sep.mf = createMaxFlow(arcs);
+	sep.capacities = calloc(arcs->m, sizeof(double));
+	sep.rowInds = calloc(arcs->m + 1, sizeof(int));
+	sep.rowVals = calloc(arcs->m + 1, sizeof(double));
+	sep.nCuts = 0;
+	sep.ws = NULL;
+	return sep;
+}
+
+static void freeCutSeparator(CutSeparator *sep) {
+	free(sep->targets);
+	freeMaxFlow(sep->mf);
+	free(sep->capacities);
+	free(sep->rowInds);
+	free(sep->rowVals);
+}
+
+static void addRow(glp_prob *lp, int len, int *inds, double *vals, int type, double lb, double ub) {
+	int row = glp_add_rows(lp, 1);
+	glp_set_mat_row(lp, row, len, inds, vals);
+	glp_set_row_bnds(lp, row, type, lb, ub);
+}
+
+static glp_prob *createGLPKProblem(Graph *arcs, Terminals *terms, int root) {
+	glp_prob *lp = glp_create_prob();
+	glp_set_prob_name(lp, "SMT ILP Directed Cut Formulation");
+	glp_set_obj_dir(lp, GLP_MIN);
+	glp_term_out(GLP_OFF); // Not verbose
+
+	// y_a columns (binary, cost in objective), arc a is column a+1
+	glp_add_cols(lp, arcs->m);
+	for (int a = 0; a < arcs->m; a++) {
+		glp_set_col_kind(lp, a+1, GLP_BV); // in {0, 1}
+		glp_set_obj_coef(lp, a+1, arcs->edges[a].cost);
+		if (arcs->edges[a].w == root || arcs->edges[a].v == arcs->edges[a].w) {
+			glp_set_col_bnds(lp, a+1, GLP_FX, 0.0, 0.0); // Nothing enters the root, loops are useless
+		}
+	}
+	return lp;
+}
+
+static void addConstraints(glp_prob *lp, Graph *g, Graph *arcs, Terminals *terms, CutSeparator *sep) {
+	int *inds = sep->rowInds;
+	double *vals = sep->rowVals;
+	bool *isTerminal = calloc(arcs->n, sizeof(bool));
+	for (int i = 0; i < terms->n; i++) {
+		isTerminal[terms->vertices[i]] = true;
+	}
+
+	for (int v = 0; v < arcs->n; v++) {
+		if (v == sep->root) {
+			continue;
+		}
+		// In-degree: exactly one arc enters a terminal, at most one any other vertex
+		int len = 0;
+		for (int i = arcs->offsets[v]; i < arcs->offsets[v+1]; i++) {
+			int a = arcs->adjEdges[i];
+			if (arcs->edges[a].w == v && arcs->edges[a].v != v) {
+				len++;
+				inds[len] = a+1;
+				vals[len] = 1.0;
+			}
+		}
+		if (isTerminal[v]) {
+			addRow(lp, len, inds, vals, GLP_FX, 1.0, 1.0);
+			continue;
+		}
+		addRow(lp, len, inds, vals, GLP_UP, 0.0, 1.0);
+
+		// Flow balance: a Steiner vertex that is entered is left again (sum_{in} y_a - sum_{out} y_a <= 0)
+		len = 0;
+		for (int i = arcs->offsets[v]; i < arcs->offsets[v+1]; i++) {
+			int a = arcs->adjEdges[i];
+			if (arcs->edges[a].v == arcs->edges[a].w) {
+				continue; // Loops appear twice in the adjacency
+			}
+			len++;
+			inds[len] = a+1;
+			vals[len] = (arcs->edges[a].w == v) ? 1.0 : -1.0;
+		}
+		addRow(lp, len, inds, vals, GLP_UP, 0.0, 0.0);
+	}
+
+	// Only one direction of an edge is used (y_{2i} + y_{2i+1} <= 1)
+	for (int i = 0; i < g->m; i++) {
+		inds[1] = 2*i + 1;
+		inds[2] = 2*i + 2;
+		vals[1] = 1.0;
+		vals[2] = 1.0;
+		addRow(lp, 2, inds, vals, GLP_UP, 0.0, 1.0);
+	}
+
+	free(isTerminal);
+}
+
+// Adds the cut of the arcs leaving the source side of the last max-flow, returns its number of arcs.
+// The capacities of these arcs are raised to 1, so the next flow to the same terminal finds a nested cut.
+static int addCut(glp_prob *lp, CutSeparator *sep) {
+	Graph *arcs = sep->arcs;
+	int len = 0;
+	for (int a = 0; a < arcs->m; a++) {
+		if (isOnSourceSide(arcs->edges[a].v, sep->mf) && !isOnSourceSide(arcs->edges[a].w, sep->mf)) {
+			len++;
+			sep->rowInds[len] = a+1;
+			sep->rowVals[len] = 1.0;
+			sep->capacities[a] = 1.0;
+		}
+	}
+	if (len > 0) {
+		addRow(lp, len, sep->rowInds, sep->rowVals, GLP_LO, 1.0, 0.0); // sum_{a in cut} y_a >= 1
+		sep->nCuts++;
+	}
+	return len;
+}
+
+// Row generation callback: the LP values are the arc capacities, a root-terminal flow below 1 yields a violated cut
+static void separateCuts(glp_tree *tree, void *info) {
+	CutSeparator *sep = info;
+	offerWarmStart(tree, sep->ws);
+	if (glp_ios_reason(tree) != GLP_IROWGEN) {
+		return;
+	}
+	glp_prob *lp = glp_ios_get_prob(tree);
+	for (int a = 0; a < sep->arcs->m; a++) {
+		sep->capacities[a] = glp_get_col_prim(lp, a+1);
+	}
+
+	for (int i = 0; i < sep->nTargets; i++) {
+		for (int k = 0; k < MAX_NESTED_CUTS; k++) {
+			double flow = computeMaxFlow(sep->root, sep->targets[i], sep->capacities, 1.0 - CUT_EPS, sep->mf);
+			if (flow >= 1.0 - CUT_EPS || addCut(lp, sep) == 0) {
+				break;
+			}
+		}
+	}
+}
+
+static void solveProblem(glp_prob *lp, CutSeparator *sep) {
+	// Without presolver, branch-and-cut starts from the solved LP relaxation
+	glp_smcp smcp;
+	glp_init_smcp(&smcp);
+	smcp.msg_lev = GLP_MSG_OFF;
+	int ret = glp_simplex(lp, &smcp);
+	if (ret == 0) {
+		glp_iocp parm;
+		glp_init_iocp(&parm);
+		parm.msg_lev = GLP_MSG_OFF;
+		parm.presolve = GLP_OFF;
+		parm.cb_func = separateCuts;
+		parm.cb_info = sep;
+		ret = glp_intopt(lp, &parm);
+	}
+	if (ret != 0) {
+		fprintf(stderr, "Error solving ILP: %d\n", ret);
+		glp_delete_prob(lp);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static SteinerTree extractSolution(glp_prob *lp, Graph *g) {
+	// Edge i is selected if one of its arcs is
+	SteinerTree st;
+	st.treeEdgeIndices = calloc(g->m + 1, sizeof(int));
+	st.n = 0;
+	for (int i = 0; i < g->m; i++) {
+		double val = glp_mip_col_val(lp, 2*i + 1) + glp_mip_col_val(lp, 2*i + 2);
+		if (val > 0.5) {
+			st.treeEdgeIndices[st.n] = i;
+			st.n++;
+		}
+	}
+	return st;
+}
+
+SteinerTree dcutIlp(Graph *g, Terminals *terms, bool warmStart) {
+	// Undirected edge i becomes the arcs 2i and 2i+1
+	double start = startPhase();
+	Graph *arcs = createDoubledGraph(g);
+	CutSeparator sep = createCutSeparator(arcs, terms);
+
+	glp_prob *lp = createGLPKProblem(arcs, terms, sep.root);
+	addConstraints(lp, g, arcs, terms, &sep);
+	endPhase(PHASE_ILP_BUILD, start);
+
+	// The warm start uses the arcs of its tree oriented away from the root
+	start = startPhase();
+	WarmStart ws;
+	if (warmStart && createWarmStart(g, terms, arcs->m, &ws)) {
+		for (int v = 0; v < g->n; v++) {
+			if (ws.preEdges[v] != -1) {
+				ws.x[parentArc(v, &ws, g) + 1] = 1.0;
+			}
+		}
+		sep.ws = &ws;
+	}
+	else if (warmStart) {
+		freeWarmStart(&ws);
+	}
+	endPhase(PHASE_WARM_START, start);
+
+	start = startPhase();
+	solveProblem(lp, &sep);
+	endPhase(PHASE_ILP_SOLVE, start);
+	addCount(COUNT_SEPARATED_CUTS, sep.nCuts);
+
+	start = startPhase();
+	SteinerTree st = extractSolution(lp, g);
+	endPhase(PHASE_ILP_EXTRACT, start);
+
+	if (sep.ws != NULL) {
+		freeWarmStart(sep.ws);
+	}
+	glp_delete_prob(lp);
+	freeCutSeparator(&sep);
+	freeGraph(arcs);
+
+	return st;
+}
@@ -0,0 +1,12 @@
+#ifndef DCUT_H
+#define DCUT_H
+
+#include "../../utils.h"
+#include "../../structures/graph.h"
+
+// Directed cut formulation: one binary variable per arc, every terminal has to be reachable from the root terminal.
+// Violated cuts are separated lazily by max-flow in the row generation callback of GLPK's branch-and-cut.
+// With warmStart, the tree of Takahashi-Matsuyama and local search is the first incumbent.
+SteinerTree dcutIlp(Graph *g, Terminals *terms, bool warmStart);
+
+#endif
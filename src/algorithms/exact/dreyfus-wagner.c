@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <limits.h>
+#include <omp.h>
+
+#include "dreyfus-wagner.h"
+#include "../dijkstra/dijkstra.h"
+#include "../../structures/buffer.h"
+#include "../../structures/union-find.h"
+
+// How the entry of a subset and a vertex was reached, values >= 0 are the last edge of a path to the vertex,
+// values < 0 other than LEAF a merge of the subsets -trace and the rest at the vertex
+#define LEAF INT_MIN
+
+// Rows of all non-empty subsets S of the non-root terminals, the entry of S and v is at (S-1)*n + v.
+// Subsets are bitmasks over the non-root terminals.
+typedef struct {
+	int n;
+	int nSubsets;
+	double *costs;
+	int *traces;
+} DPTable;
+
+bool fitsDreyfusWagner(Graph *g, Terminals *terms) {
+	int k = terms->n - 1;
+	if (k >= 31) {
+		return false;
+	}
+	double nMergeSteps = g->n;
+	for (int i = 0; i < k; i++) {
+		nMergeSteps *= 3;
+	}
+	return (double)(1L << k) * g->n <= MAX_DP_ENTRIES && nMergeSteps <= MAX_DP_WORK;
+}
+
+static int countBits(int x) {
+	int count = 0;
+	while (x != 0) {
+		x &= x - 1;
+		count++;
+	}
+	return count;
+}
+
+// Cheapest merge of two disjoint subsets that cover S at every vertex, the subset with the lowest terminal of S is A
+static void mergeSubsets(int S, DPTable *dp) {
+	double *row = &dp->costs[(size_t)(S-1) * dp->n];
+	int *traceRow = &dp->traces[(size_t)(S-1) * dp->n];
+	int lowest = S & -S;
+	for (int v = 0; v < dp->n; v++) {
+		row[v] = DBL_MAX;
+	}
+	for (int A = (S - 1) & S; A > 0; A = (A - 1) & S) {
+		if (!(A & lowest)) {
+			continue; // Same split as S^A
+		}
+		double *rowA = &dp->costs[(size_t)(A-1) * dp->n];
+		double *rowB = &dp->costs[(size_t)((S ^ A) - 1) * dp->n];
+		for (int v = 0; v < dp->n; v++) {
+			double cost = rowA[v] + rowB[v]; // Stays at least DBL_MAX if one is unreachable
+			if (cost < row[v]) {
+				row[v] = cost;
+				traceRow[v] = -A;
+			}
+		}
+	}
+}
+
+// Extends the paths of the row of S from all reached vertices, with a target only until it is settled
+static void relaxSubset(int S, int target, int *sources, double *sourceDists, PathsData *pd, DPTable *dp, Graph *g) {
+	double *row = &dp->costs[(size_t)(S-1) * dp->n];
+	int *traceRow = &dp->traces[(size_t)(S-1) * dp->n];
+	int nSources = 0;
+	for (int v = 0; v < g->n; v++) {
+		if (row[v] < DBL_MAX) {
+			sources[nSources] = v;
+			sourceDists[nSources] = row[v];
+			nSources++;
+		}
+	}
+	// The closest source goes first, so no later push lies below the minimum of the queue
+	int closest = 0;
+	for (int i = 1; i < nSources; i++) {
+		if (sourceDists[i] < sourceDists[closest]) {
+			closest = i;
+		}
+	}
+	if (nSources > 0) {
+		int source = sources[0];
+		double sourceDist = sourceDists[0];
+		sources[0] = sources[closest];
+		sourceDists[0] = sourceDists[closest];
+		sources[closest] = source;
+		sourceDists[closest] = sourceDist;
+	}
+	SearchLimits limits = noSearchLimits();
+	limits.target = target;
+	seededMultiDijkstra(sources, sourceDists, nSources, limits, pd, g);
+	for (int i = 0; i < pd->nTouched; i++) {
+		int v = pd->touched[i];
+		double dist = getDist(v, pd);
+		if (dist < row[v]) {
+			row[v] = dist;
+			traceRow[v] = pd->preEdgeIndices[v];
+		}
+	}
+	cleanPathsData(pd);
+}
+
+// Unfolds the traces of the full subset at the root into the edges of the tree
+static SteinerTree extractTree(int root, DPTable *dp, Graph *g) {
+	bool *isSelected = calloc(g->m, sizeof(bool));
+	Buffer *stack = createBuffer(sizeof(int[2]));
+	int entry[2] = {dp->nSubsets, root};
+	appendToBuffer(stack, entry);
+	while (stack->n > 0) {
+		stack->n--;
+		int S = ((int (*)[2])stack->data)[stack->n][0];
+		int v = ((int (*)[2])stack->data)[stack->n][1];
+		int trace = dp->traces[(size_t)(S-1) * dp->n + v];
+		if (trace == LEAF) {
+			continue;
+		}
+		if (trace >= 0) {
+			isSelected[trace] = true;
+			int next[2] = {S, getPredecessor(v, g->edges[trace])};
+			appendToBuffer(stack, next);
+		}
+		else {
+			int left[2] = {-trace, v};
+			int right[2] = {S ^ -trace, v};
+			appendToBuffer(stack, left);
+			appendToBuffer(stack, right);
+		}
+	}
+	freeBuffer(stack);
+
+	// Subtrees of a merge only share edges or form cycles via edges of cost 0, those are dropped
+	SteinerTree st;
+	st.treeEdgeIndices = calloc(g->n, sizeof(int));
+	st.n = 0;
+	UnionFind *uf = createUnionFind(g->n);
+	for (int i = 0; i < g->m; i++) {
+		Edge e = g->edges[i];
+		if (isSelected[i] && findSet(uf, e.v) != findSet(uf, e.w)) {
+			unionSet(uf, e.v, e.w);
+			st.treeEdgeIndices[st.n] = i;
+			st.n++;
+		}
+	}
+	freeUnionFind(uf);
+	free(isSelected);
+	return st;
+}
+
+SteinerTree dreyfusWagner(Graph *g, Terminals *terms) {
+	int k = terms->n - 1;
+	int root = terms->vertices[k];
+
+	DPTable dp;
+	dp.n = g->n;
+	dp.nSubsets = (1 << k) - 1;
+	dp.costs = calloc((size_t)dp.nSubsets * g->n, sizeof(double));
+	dp.traces = calloc((size_t)dp.nSubsets * g->n, sizeof(int));
+
+	// Subsets grouped by size, each layer only depends on smaller ones
+	int *subsets = calloc(dp.nSubsets, sizeof(int));
+	int *layerStarts = calloc(k + 2, sizeof(int));
+	for (int S = 1; S <= dp.nSubsets; S++) {
+		layerStarts[countBits(S) + 1]++;
+	}
+	for (int p = 1; p <= k; p++) {
+		layerStarts[p+1] += layerStarts[p];
+	}
+	int *nextPos = calloc(k + 1, sizeof(int));
+	for (int p = 1; p <= k; p++) {
+		nextPos[p] = layerStarts[p];
+	}
+	for (int S = 1; S <= dp.nSubsets; S++) {
+		subsets[nextPos[countBits(S)]++] = S;
+	}
+	free(nextPos);
+
+	int nThreads = omp_get_max_threads();
+	PathsData **pathsDatas = createMultiPathDatas(nThreads, g->n);
+	int **sources = calloc(nThreads, sizeof(int*));
+	double **sourceDists = calloc(nThreads, sizeof(double*));
+	for (int t = 0; t < nThreads; t++) {
+		sources[t] = calloc(g->n, sizeof(int));
+		sourceDists[t] = calloc(g->n, sizeof(double));
+	}
+
+	for (int p = 1; p <= k; p++) {
+		#pragma omp parallel for schedule(dynamic, 1)
+		for (int i = layerStarts[p]; i < layerStarts[p+1]; i++) {
+			int tID = omp_get_thread_num();
+			int S = subsets[i];
+			if (p == 1) {
+				double *row = &dp.costs[(size_t)(S-1) * g->n];
+				for (int v = 0; v < g->n; v++) {
+					row[v] = DBL_MAX;
+				}
+				int t = terms->vertices[countBits(S - 1)]; // Index of the single bit
+				row[t] = 0;
+				dp.traces[(size_t)(S-1) * g->n + t] = LEAF;
+			}
+			else {
+				mergeSubsets(S, &dp);
+			}
+			// Only the root is needed from the full subset
+			int target = (S == dp.nSubsets) ? root : -1;
+			relaxSubset(S, target, sources[tID], sourceDists[tID], pathsDatas[tID], &dp, g);
+		}
+	}
+
+	if (dp.costs[(size_t)(dp.nSubsets - 1) * g->n + root] == DBL_MAX) {
+		fprintf(stderr, "Terminals are not connected.\n");
+		exit(EXIT_FAILURE);
+	}
+	SteinerTree st = extractTree(root, &dp, g);
+
+	for (int t = 0; t < nThreads; t++) {
+		free(sources[t]);
+		free(sourceDists[t]);
+	}
+	free(sources);
+	free(sourceDists);
+	freeMultiPathsDatas(pathsDatas, nThreads);
+	free(subsets);
+	free(layerStarts);
+	free(dp.costs);
+	free(dp.traces);
+	return st;
+}
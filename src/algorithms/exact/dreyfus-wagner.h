@@ -0,0 +1,19 @@
+#ifndef DREYFUSWAGNER_H
+#define DREYFUSWAGNER_H
+
+#include <stdbool.h>
+
+#include "../../utils.h"
+#include "../../structures/graph.h"
+
+// Subset DP of Dreyfus-Wagner in the variant of Erickson-Monma-Veinott, O(3^k n + 2^k m log n) for k terminals.
+// The table holds one row of n distances per subset of the terminals except the root, so it needs 2^(k-1) n entries.
+#define MAX_DP_ENTRIES (1L << 25)
+#define MAX_DP_WORK 4e9 // Bound for 3^(k-1) n, the additions of all merges
+
+// Whether the table of g and terms fits MAX_DP_ENTRIES and its merges MAX_DP_WORK
+bool fitsDreyfusWagner(Graph *g, Terminals *terms);
+
+SteinerTree dreyfusWagner(Graph *g, Terminals *terms);
+
+#endif
@@ -5,9 +5,9 @@
 #include <limits.h>
 #include <omp.h>
 
-#include "../two-apx/two-apx.h"
-#include "../dijkstra/dijkstra.h"
 #include "ilp.h"
+#include "warm-start.h"
+#include "../../stats.h"
 
 typedef struct {
 	int nArcs;
@@ -21,12 +21,11 @@ typedef struct {
 	int nRows;
 } IlpParams;
 
+// Scratch row for glp_set_mat_row (1-indexed), reused for every row
 typedef struct {
-	int nnz;
-	int* rowInds;
-	int* colInds;
-	double* coefficients;
-} ConstraintMatrix;
+	int *inds;
+	double *vals;
+} RowBuffer;
 
 static int arcToEdge(int a) {
 	return (a / 2)+1; // 1-indexed
@@ -36,7 +35,7 @@ static int mapToFlowEntry(int a, int t, int nArcs, int nTerminals, int nX) {
 	return nX + ((t-1) * nArcs) + a+1; // 1-indexed
 }
 
-static IlpParams initIlpParams(Graph *g, Terminals *terms, bool addUpperBound) {
+static IlpParams initIlpParams(Graph *g, Terminals *terms) {
 	IlpParams params;
 
 	int nArcs = g->m;
@@ -57,92 +56,26 @@ static IlpParams initIlpParams(Graph *g, Terminals *terms, bool addUpperBound) {
 	params.nEdgeSelectConstr = (nTerminals-1) * nArcs;
 	params.nFlowConstr = (nTerminals-1) * g->n;
 	params.nRows = params.nEdgeSelectConstr + params.nFlowConstr;
-	if (addUpperBound) {
-		params.nRows++; // Add row for additional upper bound constraint
-	}
 	return params;
 }
 
-static ConstraintMatrix createConstraintMatrix(Graph *g, Terminals *terms, IlpParams params, bool addUpperBound) {
-	// Sparse matrix (only non-zero values)
-	ConstraintMatrix matrix;
-	int nTerminals = terms->n;
-	int nnzEdgeSelect = 2 * params.nEdgeSelectConstr; //Edge Select. rows have exactly 2 non-zero (f^t_a, x_e)
-	int nnzFlow = (nTerminals-1) * sumOfDegrees(g); // Flow rows have have degree(v) non-zero values
-	matrix.nnz = nnzEdgeSelect + nnzFlow;
-	if (addUpperBound) {
-		matrix.nnz += params.m; // Additional nonzero entries for the upper bound row
-	}
-
-	matrix.rowInds = calloc(matrix.nnz+1, sizeof(int));
-	matrix.colInds = calloc(matrix.nnz+1, sizeof(int));
-	matrix.coefficients = calloc(matrix.nnz+1, sizeof(double));
-
-	int rowI = 1;
-	int nzI = 1;
-
-	// Edge-Selection Constraints (f^t_a - x_e <= 0)
-	for (int t = 1; t < nTerminals; t++) {
-		for (int a = 0; a < params.nArcs; a++) {
-			int colFlow = mapToFlowEntry(a, t, params.nArcs, nTerminals, params.nX);
-			int colEdge = arcToEdge(a);
-
-			// +1 for f^t_a
-			matrix.rowInds[nzI] = rowI;
-			matrix.colInds[nzI] = colFlow;
-			matrix.coefficients[nzI] = 1.0;
-			nzI++;
-
-			// -1 for x_{ae(a)}
-			matrix.rowInds[nzI] = rowI;
-			matrix.colInds[nzI] = colEdge;
-			matrix.coefficients[nzI] = -1.0;
-			nzI++;
-
-			rowI++;
-		}
-	}
-
-	// Flow Conservation Constraints
-	// sum_{out} f^t_{(v,w)} - sum_{in} f^t_{(w,v)} = b^t(v)
-	for (int t = 1; t < nTerminals; t++) {
-		for (int v = 0; v < g->n; v++) {
-			int deg = g->vertices[v].deg;
-			for (int j = 0; j < deg; j++) {
-				int a = g->vertices[v].edges[j];
-				int colFlow = mapToFlowEntry(a, t, params.nArcs, nTerminals, params.nX);
-
-				// Arc is out => coefficient = +1
-				// Arc is in => coefficient = -1
-				double coef = (g->edges[a].v == v) ? 1.0 : -1.0;
-
-				matrix.rowInds[nzI] = rowI;
-				matrix.colInds[nzI] = colFlow;
-				matrix.coefficients[nzI] = coef;
-				nzI++;
-			}
-			rowI++;
-		}
-	}
-
-
-	// Optional Upper-Bound Row: sum_{e} c(e) * x_e <= upBound
-	if (addUpperBound) {
-		int ubRow = params.nRows;
-		for (int i = 1; i <= params.m; i++) {
-			matrix.rowInds[nzI] = ubRow;
-			matrix.colInds[nzI] = i;
-			matrix.coefficients[nzI] = g->edges[2 * (i-1)].cost;
-			nzI++;
+static RowBuffer createRowBuffer(Graph *g) {
+	// Longest row: flow conservation of the vertex with most arcs
+	int maxLen = 2;
+	for (int v = 0; v < g->n; v++) {
+		if (getDegree(v, g) > maxLen) {
+			maxLen = getDegree(v, g);
 		}
 	}
-	return matrix;
+	RowBuffer row;
+	row.inds = calloc(maxLen+1, sizeof(int));
+	row.vals = calloc(maxLen+1, sizeof(double));
+	return row;
 }
 
-static void freeConstraintMatrix(ConstraintMatrix *matrix) {
-	free(matrix->rowInds);
-	free(matrix->colInds);
-	free(matrix->coefficients);
+static void freeRowBuffer(RowBuffer *row) {
+	free(row->inds);
+	free(row->vals);
 }
 
 static glp_prob *createGLPKProblem(Graph *g, Terminals *terms, IlpParams params) {
@@ -155,18 +88,40 @@ static glp_prob *createGLPKProblem(Graph *g, Terminals *terms, IlpParams params)
 	return lp;
 }
 
-static void addConstraints(glp_prob *lp, Graph *g, Terminals *terms, IlpParams params, bool addUpperBound) {
-	// Edge-Selection Constraints
-	for (int i = 1; i <= params.nEdgeSelectConstr; i++) {	
-		glp_set_row_bnds(lp, i, GLP_UP, 0.0, 0.0); // <= 0
+static void addConstraints(glp_prob *lp, Graph *g, Terminals *terms, IlpParams params) {
+	RowBuffer row = createRowBuffer(g);
+	int nTerminals = terms->n;
+	int rowI = 1;
+
+	// Edge-Selection Constraints (f^t_a - x_e <= 0)
+	for (int t = 1; t < nTerminals; t++) {
+		for (int a = 0; a < params.nArcs; a++) {
+			row.inds[1] = mapToFlowEntry(a, t, params.nArcs, nTerminals, params.nX); // +1 for f^t_a
+			row.vals[1] = 1.0;
+			row.inds[2] = arcToEdge(a); // -1 for x_{ae(a)}
+			row.vals[2] = -1.0;
+			glp_set_mat_row(lp, rowI, 2, row.inds, row.vals);
+			glp_set_row_bnds(lp, rowI, GLP_UP, 0.0, 0.0); // <= 0
+			rowI++;
+		}
 	}
 
-	// Flow-Conservation Constraints
-	int flowRowStart = params.nEdgeSelectConstr + 1;
-	int rowI = flowRowStart;
-	for (int t = 1; t < terms->n; t++) {
+	// Flow Conservation Constraints
+	// sum_{out} f^t_{(v,w)} - sum_{in} f^t_{(w,v)} = b^t(v)
+	for (int t = 1; t < nTerminals; t++) {
 		int terminal = terms->vertices[t];
 		for (int v = 0; v < g->n; v++) {
+			int len = 0;
+			for (int j = g->offsets[v]; j < g->offsets[v+1]; j++) {
+				int a = g->adjEdges[j];
+				len++;
+				row.inds[len] = mapToFlowEntry(a, t, params.nArcs, nTerminals, params.nX);
+				// Arc is out => coefficient = +1
+				// Arc is in => coefficient = -1
+				row.vals[len] = (g->edges[a].v == v) ? 1.0 : -1.0;
+			}
+			glp_set_mat_row(lp, rowI, len, row.inds, row.vals);
+
 			double rhs = 0.0;
 			if (v == params.root) {
 				rhs = 1.0;
@@ -179,14 +134,7 @@ static void addConstraints(glp_prob *lp, Graph *g, Terminals *terms, IlpParams p
 		}
 	}
 
-	if (addUpperBound) {
-		// Compute upper bound using 2-APX algorithm
-		SteinerTree stApprox = parallelTwoAPX(g, terms);
-		double upBound = sumEdgeCosts(stApprox.treeEdgeIndices, stApprox.n, g);
-
-		glp_set_row_bnds(lp, params.nRows, GLP_UP, 0.0, upBound);
-		free(stApprox.treeEdgeIndices);
-	}
+	freeRowBuffer(&row);
 }
 
 static void addCoefficients(glp_prob *lp, Graph *g, IlpParams params) {
@@ -207,22 +155,36 @@ static void addCoefficients(glp_prob *lp, Graph *g, IlpParams params) {
 	}
 }
 
-static void solveProblem(glp_prob *lp, ConstraintMatrix matrix) {
+static void offerIncumbent(glp_tree *tree, void *info) {
+	offerWarmStart(tree, info);
+}
+
+static void solveProblem(glp_prob *lp, WarmStart *ws) {
 	glp_iocp parm;
 	glp_init_iocp(&parm);
 	parm.presolve = GLP_ON;
-	int ret = glp_intopt(lp, &parm);
+	int ret = 0;
+	if (ws != NULL) {
+		// Callbacks see the presolved problem, so the warm start needs the original one with a solved LP relaxation
+		glp_smcp smcp;
+		glp_init_smcp(&smcp);
+		smcp.msg_lev = GLP_MSG_OFF;
+		ret = glp_simplex(lp, &smcp);
+		parm.presolve = GLP_OFF;
+		parm.cb_func = offerIncumbent;
+		parm.cb_info = ws;
+	}
+	if (ret == 0) {
+		ret = glp_intopt(lp, &parm);
+	}
 	if (ret != 0) {
 		fprintf(stderr, "Error solving ILP: %d\n", ret);
 		glp_delete_prob(lp);
-		free(matrix.rowInds);
-		free(matrix.colInds);
-		free(matrix.coefficients);
 		exit(EXIT_FAILURE);
 	}
 }
 
-static SteinerTree extractSolution(glp_prob *lp, Graph *g, IlpParams params, ConstraintMatrix matrix) {
+static SteinerTree extractSolution(glp_prob *lp, Graph *g, IlpParams params) {
 	// Extract values of vector x which represent selected edges
 	SteinerTree st;
 	if (params.nX <= 0) {
@@ -235,117 +197,68 @@ static SteinerTree extractSolution(glp_prob *lp, Graph *g, IlpParams params, Con
 		// Collect respective undirected edge
 		int val = (int) glp_mip_col_val(lp, i);
 		if (val == 1) {
-			st.treeEdgeIndices[st.n] = 2 * (i-1); // Choose first arc of pair
+			st.treeEdgeIndices[st.n] = i-1; // Index of the undirected edge
 			st.n++;
 		}
 	}
 	return st;
 }
 
-static void reduceGraph(Graph *g) {
-	int nEdges = g->m / 2;
-	bool *removeEdges = calloc(nEdges, sizeof(bool));
-	int *newPos = calloc(nEdges, sizeof(int));
-	for (int i = 0; i < nEdges; i++) {
-		newPos[i] = i;
-	}
-
-	// Run dijkstra for each undirected edge
-	int nThreads = omp_get_max_threads();
-	PathsData **pathsDatas = createMultiPathDatas(nThreads, g->n);
-
-	#pragma omp parallel for schedule(dynamic)
-	for (int i = 0; i < nEdges; i++) {
-		int tID = omp_get_thread_num();
-		Edge e = g->edges[2*i];
-		
-		dijkstra(e.v, pathsDatas[tID], g);
-		
-		int costSum = sumEdgeCosts(pathsDatas[tID]->preEdgeIndices, g->n, g);
-		if (costSum < e.cost) {
-			// There is a shorter path which makes the edge not used in any min ST
-			removeEdges[i] = true;
-		}
-		cleanPathsData(pathsDatas[tID], g->n);
-	}
-
-	int left = 0;
-	int right = nEdges-1;
-	while (left < right) {
-		while (left < nEdges && !removeEdges[left]) {
-			// Find next edge to remove (swap to the end)
-			left++;
-		}
-		while (right >= 0 && removeEdges[right]) {
-			// Find next staying edge index (swap with edge to remove)
-			right--;
-		}
-		if (left < right) {
-			// Swap edge pair of left with right
-			Edge temp1 = g->edges[2*left];
-			Edge temp2 = g->edges[2*left + 1];
-			
-			g->edges[2*left] = g->edges[2*right];
-			g->edges[2*left + 1] = g->edges[2*right + 1];
-			g->edges[2*right] = temp1;
-			g->edges[2*right + 1]= temp2;
-
-			newPos[right] = left; // Update mapping of kept edge
-			removeEdges[left] = false;
-			removeEdges[right] = true;
-			left++;
-			right--;
-		}
-	}
-
-	// Count kept edges
-	int newCount = 0;
-	for (int i = 0; i < nEdges; i++) {
-		if (!removeEdges[i]) {
-			newCount++;
+// Tree edges set x_e, the path from the root to terminal t sets the flow f^t_a of its arcs
+static void setWarmStartValues(WarmStart *ws, Graph *g, Terminals *terms, IlpParams params) {
+	for (int v = 0; v < g->n; v++) {
+		if (ws->preEdges[v] != -1) {
+			ws->x[ws->preEdges[v] + 1] = 1.0;
 		}
 	}
-
-	g->m = newCount * 2;
-	g->edges = realloc(g->edges, g->m * sizeof(Edge));
-
-	// Update adjacency array using new positions
-	for (int v = 0; v < g->n; v++) {
-		for (int j = 0; j < g->vertices[v].deg; j++) {
-			int oldArcI = g->vertices[v].edges[j];
-			int undirectedI = oldArcI / 2;
-			int rem = oldArcI % 2;
-			g->vertices[v].edges[j] = newPos[undirectedI]*2 + rem;
+	for (int t = 1; t < terms->n; t++) {
+		int u = terms->vertices[t];
+		while (ws->preEdges[u] != -1) {
+			int a = parentArc(u, ws, g);
+			ws->x[mapToFlowEntry(a, t, params.nArcs, terms->n, params.nX)] = 1.0;
+			u = getPredecessor(u, g->edges[ws->preEdges[u]]);
 		}
 	}
-
-	free(removeEdges);
-	free(newPos);
-	freeMultiPathsDatas(pathsDatas, nThreads);
 }
 
-SteinerTree ilp(Graph *g, Terminals *terms, bool addUpperBound, bool reduceG) {
-	if (reduceG) {
-		reduceGraph(g);
-	}
+SteinerTree ilp(Graph *g, Terminals *terms, bool warmStart) {
+	// Formulation works on arcs, undirected edge i becomes the arcs 2i and 2i+1
+	double start = startPhase();
+	Graph *arcs = createDoubledGraph(g);
 
-	IlpParams params = initIlpParams(g, terms, addUpperBound);
+	IlpParams params = initIlpParams(arcs, terms);
 
-	ConstraintMatrix matrix = createConstraintMatrix(g, terms, params, addUpperBound);
+	glp_prob *lp = createGLPKProblem(arcs, terms, params);
 
-	glp_prob *lp = createGLPKProblem(g, terms, params);
+	// Columns have to exist before the rows are set, rows are loaded one at a time
+	addCoefficients(lp, arcs, params);
+	addConstraints(lp, arcs, terms, params);
+	endPhase(PHASE_ILP_BUILD, start);
 
-	addConstraints(lp, g, terms, params, addUpperBound);
-	addCoefficients(lp, g, params);
-
-	glp_load_matrix(lp, matrix.nnz, matrix.rowInds, matrix.colInds, matrix.coefficients);
+	start = startPhase();
+	WarmStart ws;
+	bool hasWarmStart = warmStart && createWarmStart(g, terms, params.nCols, &ws);
+	if (hasWarmStart) {
+		setWarmStartValues(&ws, g, terms, params);
+	}
+	else if (warmStart) {
+		freeWarmStart(&ws);
+	}
+	endPhase(PHASE_WARM_START, start);
 	
-	solveProblem(lp, matrix);
+	start = startPhase();
+	solveProblem(lp, hasWarmStart ? &ws : NULL);
+	endPhase(PHASE_ILP_SOLVE, start);
 
-	SteinerTree st = extractSolution(lp, g, params, matrix);
+	start = startPhase();
+	SteinerTree st = extractSolution(lp, arcs, params);
+	endPhase(PHASE_ILP_EXTRACT, start);
 
-	freeConstraintMatrix(&matrix);
+	if (hasWarmStart) {
+		freeWarmStart(&ws);
+	}
 	glp_delete_prob(lp);
+	freeGraph(arcs);
 
 	return st;
 }
@@ -4,6 +4,7 @@
 #include "../../utils.h"
 #include "../../structures/graph.h"
 
-SteinerTree ilp(Graph *g, Terminals *terms, bool addUpperBound, bool reduceG);
+// Multi-commodity flow formulation. With warmStart, the tree of Takahashi-Matsuyama and local search is the first incumbent.
+SteinerTree ilp(Graph *g, Terminals *terms, bool warmStart);
 
 #endif
@@ -0,0 +1,440 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tree-decomposition-dp.h"
+#include "../heuristic/heuristic.h"
+#include "../../structures/state-table.h"
+#include "../../structures/buffer.h"
+#include "../../structures/union-find.h"
+#include "../../stats.h"
+
+// Sorted vertices of the bag of a node
+typedef struct {
+	int size;
+	int vertices[MAX_TD_BAG_SIZE];
+} Bag;
+
+typedef struct {
+	NiceTreeDecomposition *ntd;
+	StateTable **tables; // Only while the parent is not computed
+	int **traces; // Compact form of each entry afterwards, see compactTable
+	Bag **bags;
+	bool *isTerminal;
+	double upperBound; // States above cannot be part of a better tree than the one of Takahashi-Matsuyama
+	long nStates;
+	Graph *g;
+} TDContext;
+
+static void decodeLabels(uint64_t key, int size, int *labels) {
+	for (int p = 0; p < size; p++) {
+		labels[p] = (key >> (4*p)) & 15;
+	}
+}
+
+// Numbers the components by their first position, so equal partitions get equal keys
+static uint64_t encodeLabels(int *labels, int size) {
+	int renamed[MAX_TD_BAG_SIZE + 2] = {0};
+	int nComponents = 0;
+	uint64_t key = 0;
+	for (int p = 0; p < size; p++) {
+		int l = labels[p];
+		if (l != 0) {
+			if (renamed[l] == 0) {
+				nComponents++;
+				renamed[l] = nComponents;
+			}
+			key |= (uint64_t)renamed[l] << (4*p);
+		}
+	}
+	return key;
+}
+
+static int findPosition(int v, Bag *bag) {
+	for (int p = 0; p < bag->size; p++) {
+		if (bag->vertices[p] == v) {
+			return p;
+		}
+	}
+	return -1;
+}
+
+static void offer(uint64_t key, double cost, int from0, int from1, StateTable *t, TDContext *ctx) {
+	if (cost <= ctx->upperBound) {
+		offerState(key, cost, from0, from1, t);
+	}
+}
+
+static StateTable *leafTable(Bag *bag, TDContext *ctx) {
+	bag->size = 1;
+	bag->vertices[0] = ctx->ntd->rootVertex;
+	StateTable *t = createStateTable(1);
+	offerState(1, 0, -1, -1, t); // Root vertex in its own component
+	return t;
+}
+
+static StateTable *introduceVertex(int v, StateTable *child, Bag *bag, TDContext *ctx) {
+	int p = 0;
+	while (p < bag->size && bag->vertices[p] < v) {
+		p++;
+	}
+	for (int q = bag->size; q > p; q--) {
+		bag->vertices[q] = bag->vertices[q-1];
+	}
+	bag->vertices[p] = v;
+	bag->size++;
+
+	StateTable *t = createStateTable(2 * child->n);
+	int childLabels[MAX_TD_BAG_SIZE];
+	int labels[MAX_TD_BAG_SIZE];
+	for (int j = 0; j < child->n; j++) {
+		decodeLabels(child->entries[j].key, bag->size - 1, childLabels);
+		for (int q = 0; q < bag->size; q++) {
+			labels[q] = (q < p) ? childLabels[q] : (q > p) ? childLabels[q-1] : 0;
+		}
+		if (!ctx->isTerminal[v]) {
+			offer(encodeLabels(labels, bag->size), child->entries[j].cost, j, -1, t, ctx);
+		}
+		labels[p] = MAX_TD_BAG_SIZE; // New component, not used by any other vertex
+		offer(encodeLabels(labels, bag->size), child->entries[j].cost, j, -1, t, ctx);
+	}
+	return t;
+}
+
+// Keeps each state, if both ends are in different components also with the edge joining them
+static StateTable *introduceEdge(int e, StateTable *child, Bag *bag, TDContext *ctx) {
+	Edge edge = ctx->g->edges[e];
+	int pv = findPosition(edge.v, bag);
+	int pw = findPosition(edge.w, bag);
+
+	StateTable *t = createStateTable(2 * child->n);
+	int labels[MAX_TD_BAG_SIZE];
+	for (int j = 0; j < child->n; j++) {
+		StateEntry entry = child->entries[j];
+		offer(entry.key, entry.cost, j, 0, t, ctx);
+		decodeLabels(entry.key, bag->size, labels);
+		int lv = labels[pv];
+		int lw = labels[pw];
+		if (lv != 0 && lw != 0 && lv != lw) {
+			for (int q = 0; q < bag->size; q++) {
+				if (labels[q] == lw) {
+					labels[q] = lv;
+				}
+			}
+			offer(encodeLabels(labels, bag->size), entry.cost + edge.cost, j, 1, t, ctx);
+		}
+	}
+	return t;
+}
+
+// A component that only consists of v can never reach the root vertex again, so its states are dropped
+static StateTable *forgetVertex(int v, StateTable *child, Bag *bag, TDContext *ctx) {
+	int p = findPosition(v, bag);
+	StateTable *t = createStateTable(child->n);
+	int labels[MAX_TD_BAG_SIZE];
+	for (int j = 0; j < child->n; j++) {
+		decodeLabels(child->entries[j].key, bag->size, labels);
+		int l = labels[p];
+		bool isConnected = l == 0;
+		for (int q = 0; q < bag->size && !isConnected; q++) {
+			isConnected = q != p && labels[q] == l;
+		}
+		if (!isConnected) {
+			continue;
+		}
+		for (int q = p; q < bag->size - 1; q++) {
+			labels[q] = labels[q+1];
+		}
+		offer(encodeLabels(labels, bag->size - 1), child->entries[j].cost, j, -1, t, ctx);
+	}
+	for (int q = p; q < bag->size - 1; q++) {
+		bag->vertices[q] = bag->vertices[q+1];
+	}
+	bag->size--;
+	return t;
+}
+
+static int findLabel(int *parents, int l) {
+	while (parents[l] != l) {
+		l = parents[l];
+	}
+	return l;
+}
+
+// Combines the states of both children that use the same vertices, components of either are connected
+static StateTable *joinTables(StateTable *left, StateTable *right, Bag *bag, TDContext *ctx) {
+	// Entries of right grouped by the vertices they use, with their labels decoded once
+	int size = bag->size;
+	int nMasks = 1 << size;
+	int *maskStarts = calloc(nMasks + 1, sizeof(int));
+	int *byMask = calloc(right->n + 1, sizeof(int));
+	int *masks = calloc(right->n + 1, sizeof(int));
+	unsigned char *rightLabels = calloc((size_t)right->n * size + 1, sizeof(unsigned char));
+	int labels[MAX_TD_BAG_SIZE];
+	for (int j = 0; j < right->n; j++) {
+		decodeLabels(right->entries[j].key, size, labels);
+		for (int q = 0; q < size; q++) {
+			masks[j] |= (labels[q] != 0) << q;
+		}
+		maskStarts[masks[j] + 1]++;
+	}
+	for (int m = 0; m < nMasks; m++) {
+		maskStarts[m+1] += maskStarts[m];
+	}
+	int *fill = calloc(nMasks, sizeof(int));
+	for (int j = 0; j < right->n; j++) {
+		int k = maskStarts[masks[j]] + fill[masks[j]]++;
+		byMask[k] = j;
+		decodeLabels(right->entries[j].key, size, labels);
+		for (int q = 0; q < size; q++) {
+			rightLabels[(size_t)k * size + q] = labels[q];
+		}
+	}
+	free(fill);
+	free(masks);
+
+	StateTable *t = createStateTable(left->n);
+	int leftLabels[MAX_TD_BAG_SIZE];
+	// Stops early once the cap is exceeded, the caller gives up then
+	for (int i = 0; i < left->n && ctx->nStates + t->n <= MAX_TD_STATES; i++) {
+		decodeLabels(left->entries[i].key, size, leftLabels);
+		int mask = 0;
+		for (int q = 0; q < size; q++) {
+			mask |= (leftLabels[q] != 0) << q;
+		}
+		for (int k = maskStarts[mask]; k < maskStarts[mask+1]; k++) {
+			int j = byMask[k];
+			double cost = left->entries[i].cost + right->entries[j].cost;
+			if (cost > ctx->upperBound) {
+				continue;
+			}
+			// Left label of the first vertex per right label, the later ones are merged into it
+			unsigned char *r = &rightLabels[(size_t)k * size];
+			int parents[MAX_TD_BAG_SIZE + 1];
+			int firstLeft[MAX_TD_BAG_SIZE + 1] = {0};
+			for (int l = 0; l <= size; l++) {
+				parents[l] = l;
+			}
+			for (int q = 0; q < size; q++) {
+				if (r[q] == 0) {
+					continue;
+				}
+				if (firstLeft[r[q]] == 0) {
+					firstLeft[r[q]] = leftLabels[q];
+				}
+				else {
+					parents[findLabel(parents, leftLabels[q])] = findLabel(parents, firstLeft[r[q]]);
+				}
+			}
+			for (int q = 0; q < size; q++) {
+				labels[q] = findLabel(parents, leftLabels[q]);
+			}
+			offerState(encodeLabels(labels, size), cost, i, j, t);
+		}
+	}
+	free(maskStarts);
+	free(byMask);
+	free(rightLabels);
+	return t;
+}
+
+// Follows the entries from the root state down and collects the used edges
+static SteinerTree extractTree(int rootEntry, TDContext *ctx) {
+	Graph *g = ctx->g;
+	NiceTreeDecomposition *ntd = ctx->ntd;
+	bool *isSelected = calloc(g->m, sizeof(bool));
+	Buffer *stack = createBuffer(sizeof(int[2]));
+	int entry[2] = {ntd->nNodes - 1, rootEntry};
+	appendToBuffer(stack, entry);
+	while (stack->n > 0) {
+		stack->n--;
+		int node = ((int (*)[2])stack->data)[stack->n][0];
+		int j = ((int (*)[2])stack->data)[stack->n][1];
+		int *trace = ctx->traces[node];
+		int from = trace[j];
+		if (ntd->types[node] == NICE_LEAF) {
+			continue;
+		}
+		if (ntd->types[node] == NICE_INTRODUCE_EDGE && from < 0) {
+			isSelected[ntd->items[node]] = true;
+			from = -from - 1;
+		}
+		if (ntd->types[node] == NICE_JOIN) {
+			from = trace[2*j];
+			int other[2] = {ntd->children[2*node + 1], trace[2*j + 1]};
+			appendToBuffer(stack, other);
+		}
+		int next[2] = {ntd->children[2*node], from};
+		appendToBuffer(stack, next);
+	}
+	freeBuffer(stack);
+
+	// Joins may close cycles of edges with cost 0, those are dropped
+	SteinerTree st;
+	st.treeEdgeIndices = calloc(g->n, sizeof(int));
+	st.n = 0;
+	UnionFind *uf = createUnionFind(g->n);
+	for (int i = 0; i < g->m; i++) {
+		Edge e = g->edges[i];
+		if (isSelected[i] && findSet(uf, e.v) != findSet(uf, e.w)) {
+			unionSet(uf, e.v, e.w);
+			st.treeEdgeIndices[st.n] = i;
+			st.n++;
+		}
+	}
+	freeUnionFind(uf);
+	free(isSelected);
+	return st;
+}
+
+// Replaces the table of a node by the entries of the children each of its states was built from.
+// Joins keep both, introduced edges are marked by -(entry+1) if the edge is used.
+static void compactTable(int node, TDContext *ctx) {
+	StateTable *t = ctx->tables[node];
+	NiceNodeType type = ctx->ntd->types[node];
+	int *trace = calloc((type == NICE_JOIN) ? 2 * t->n + 1 : t->n + 1, sizeof(int));
+	for (int j = 0; j < t->n; j++) {
+		int *from = t->entries[j].from;
+		if (type == NICE_JOIN) {
+			trace[2*j] = from[0];
+			trace[2*j + 1] = from[1];
+		}
+		else {
+			trace[j] = (type == NICE_INTRODUCE_EDGE && from[1] == 1) ? -from[0] - 1 : from[0];
+		}
+	}
+	freeStateTable(t);
+	ctx->tables[node] = NULL;
+	ctx->traces[node] = trace;
+}
+
+static NiceTreeDecomposition *prepareDecomposition(Graph *g, int rootVertex, TreeDecomposition *given) {
+	if (given != NULL && given->width <= MAX_TD_WIDTH) {
+		NiceTreeDecomposition *ntd = createNiceTreeDecomposition(given, rootVertex, g);
+		if (ntd != NULL) {
+			return ntd;
+		}
+		fprintf(stderr, "Tree decomposition of the input file is invalid, a min-degree decomposition is used instead.\n");
+	}
+	TreeDecomposition *td = minDegreeDecomposition(g, MAX_TD_WIDTH);
+	if (td == NULL) {
+		return NULL;
+	}
+	NiceTreeDecomposition *ntd = createNiceTreeDecomposition(td, rootVertex, g);
+	freeTreeDecomposition(td);
+	return ntd;
+}
+
+static void freeTables(TDContext *ctx) {
+	for (int i = 0; i < ctx->ntd->nNodes; i++) {
+		if (ctx->tables[i] != NULL) {
+			freeStateTable(ctx->tables[i]);
+		}
+		free(ctx->traces[i]);
+		free(ctx->bags[i]);
+	}
+	free(ctx->tables);
+	free(ctx->traces);
+	free(ctx->bags);
+	free(ctx->isTerminal);
+	freeNiceTreeDecomposition(ctx->ntd);
+}
+
+bool treeDecompositionDP(Graph *g, Terminals *terms, TreeDecomposition *given, SteinerTree *st) {
+	NiceTreeDecomposition *ntd = prepareDecomposition(g, terms->vertices[0], given);
+	if (ntd == NULL) {
+		return false;
+	}
+
+	TDContext ctx;
+	ctx.ntd = ntd;
+	ctx.g = g;
+	ctx.tables = calloc(ntd->nNodes, sizeof(StateTable*));
+	ctx.traces = calloc(ntd->nNodes, sizeof(int*));
+	ctx.bags = calloc(ntd->nNodes, sizeof(Bag*));
+	ctx.isTerminal = calloc(g->n, sizeof(bool));
+	ctx.nStates = 0;
+	for (int i = 0; i < terms->n; i++) {
+		ctx.isTerminal[terms->vertices[i]] = true;
+	}
+	SteinerTree tmST = takahashiMatsuyama(g, terms);
+	double tmCost = sumEdgeCosts(tmST.treeEdgeIndices, tmST.n, g);
+	ctx.upperBound = tmCost + 1e-9 * tmCost; // Slack for the rounding of other summation orders
+	free(tmST.treeEdgeIndices);
+
+	bool *isIntroduced = calloc(g->n, sizeof(bool));
+	isIntroduced[ntd->rootVertex] = true;
+	for (int i = 0; i < ntd->nNodes; i++) {
+		int c0 = ntd->children[2*i];
+		int c1 = ntd->children[2*i + 1];
+		Bag *bag = calloc(1, sizeof(Bag));
+		if (c0 != -1) {
+			*bag = *ctx.bags[c0];
+		}
+		StateTable *t;
+		switch (ntd->types[i]) {
+			case NICE_LEAF:
+				t = leafTable(bag, &ctx);
+				break;
+			case NICE_INTRODUCE:
+				isIntroduced[ntd->items[i]] = true;
+				t = introduceVertex(ntd->items[i], ctx.tables[c0], bag, &ctx);
+				break;
+			case NICE_INTRODUCE_EDGE:
+				t = introduceEdge(ntd->items[i], ctx.tables[c0], bag, &ctx);
+				break;
+			case NICE_FORGET:
+				t = forgetVertex(ntd->items[i], ctx.tables[c0], bag, &ctx);
+				break;
+			default:
+				t = joinTables(ctx.tables[c0], ctx.tables[c1], bag, &ctx);
+		}
+		freeStateSlots(t);
+		ctx.tables[i] = t;
+		ctx.bags[i] = bag;
+		ctx.nStates += t->n;
+
+		// Of the children, only the traces are needed for the extraction of the tree
+		if (c0 != -1) {
+			free(ctx.bags[c0]);
+			ctx.bags[c0] = NULL;
+			compactTable(c0, &ctx);
+		}
+		if (c1 != -1) {
+			free(ctx.bags[c1]);
+			ctx.bags[c1] = NULL;
+			compactTable(c1, &ctx);
+		}
+		if (ctx.nStates > MAX_TD_STATES) {
+			addCount(COUNT_TD_OVER_STATE_CAP, 1);
+			freeTables(&ctx);
+			free(isIntroduced);
+			return false;
+		}
+	}
+
+	// The root bag only holds the root vertex
+	StateTable *rootTable = ctx.tables[ntd->nNodes - 1];
+	int rootEntry = -1;
+	for (int j = 0; j < rootTable->n; j++) {
+		if (rootTable->entries[j].key == 1) {
+			rootEntry = j;
+		}
+	}
+	bool isCovered = true;
+	for (int i = 0; i < terms->n; i++) {
+		isCovered &= isIntroduced[terms->vertices[i]]; // Terminals in no bag are isolated
+	}
+	free(isIntroduced);
+	if (rootEntry == -1 || !isCovered) {
+		fprintf(stderr, "Terminals are not connected.\n");
+		exit(EXIT_FAILURE);
+	}
+	addCount(COUNT_TD_SOLVED, 1);
+	addCount(COUNT_TD_NODES, ntd->nNodes);
+	addCount(COUNT_TD_STATES, ctx.nStates);
+	raiseCount(COUNT_TD_MAX_WIDTH, ntd->width);
+	compactTable(ntd->nNodes - 1, &ctx);
+	*st = extractTree(rootEntry, &ctx);
+	freeTables(&ctx);
+	return true;
+}
@@ -0,0 +1,20 @@
+#ifndef TREE_DECOMPOSITION_DP_H
+#define TREE_DECOMPOSITION_DP_H
+
+#include <stdbool.h>
+
+#include "../../utils.h"
+#include "../../structures/graph.h"
+#include "../../structures/tree-decomposition.h"
+
+// A state labels each vertex of a bag with 4 bits: 0 if it is not in the partial solution, else its component
+#define MAX_TD_BAG_SIZE 15
+#define MAX_TD_WIDTH 8 // Largest width of a decomposition of the graph that is solved by the DP, the root terminal adds one
+#define MAX_TD_STATES (1L << 25) // States of all tables, beyond the DP gives up
+
+// Exact DP over a nice tree decomposition with the first terminal in all bags. Uses the given decomposition
+// (may be NULL) or else a min-degree decomposition. Returns false if neither has width at most MAX_TD_WIDTH
+// or the tables exceed MAX_TD_STATES.
+bool treeDecompositionDP(Graph *g, Terminals *terms, TreeDecomposition *given, SteinerTree *st);
+
+#endif
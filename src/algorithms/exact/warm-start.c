@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "warm-start.h"
+#include "../heuristic/heuristic.h"
+#include "../local-search/local-search.h"
+#include "../mst/mst.h"
+
+bool createWarmStart(Graph *g, Terminals *terms, int nCols, WarmStart *ws) {
+	SteinerTree tmST = takahashiMatsuyama(g, terms);
+	SteinerTree st = localSearch(g, terms, tmST, 0);
+	free(tmST.treeEdgeIndices);
+
+	bool *selectedEdges = calloc(g->m, sizeof(bool));
+	for (int i = 0; i < st.n; i++) {
+		selectedEdges[st.treeEdgeIndices[i]] = true;
+	}
+	ws->preEdges = orientSpanningTree(selectedEdges, terms->vertices[0], g);
+	ws->cost = sumEdgeCosts(st.treeEdgeIndices, st.n, g);
+	ws->x = calloc(nCols + 1, sizeof(double));
+	ws->offered = false;
+	free(selectedEdges);
+	free(st.treeEdgeIndices);
+
+	for (int i = 1; i < terms->n; i++) {
+		int t = terms->vertices[i];
+		if (t != terms->vertices[0] && ws->preEdges[t] == -1) {
+			return false; // Terminals are not connected
+		}
+	}
+	return true;
+}
+
+void freeWarmStart(WarmStart *ws) {
+	free(ws->preEdges);
+	free(ws->x);
+}
+
+int parentArc(int v, WarmStart *ws, Graph *g) {
+	int e = ws->preEdges[v];
+	return (g->edges[e].w == v) ? 2*e : 2*e + 1;
+}
+
+void offerWarmStart(glp_tree *tree, WarmStart *ws) {
+	if (ws == NULL || ws->offered || glp_ios_reason(tree) != GLP_IHEUR) {
+		return;
+	}
+	ws->offered = true;
+	if (glp_ios_heur_sol(tree, ws->x) != 0) {
+		fprintf(stderr, "Warm start with cost %.2lf was rejected.\n", ws->cost);
+	}
+}
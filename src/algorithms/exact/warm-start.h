@@ -0,0 +1,29 @@
+#ifndef WARMSTART_H
+#define WARMSTART_H
+
+#include <glpk.h>
+#include <stdbool.h>
+
+#include "../../utils.h"
+#include "../../structures/graph.h"
+
+// Heuristic tree handed to GLPK as first incumbent, its cost then prunes the branch-and-bound
+typedef struct {
+	int *preEdges; // Tree edge to the parent per vertex, oriented away from the root terminal (-1 for root and non-tree vertices)
+	double cost;
+	double *x; // Column values of the tree in the formulation (1-indexed)
+	bool offered;
+} WarmStart;
+
+// Runs Takahashi-Matsuyama followed by local search. Returns false if the tree misses terminals.
+bool createWarmStart(Graph *g, Terminals *terms, int nCols, WarmStart *ws);
+
+void freeWarmStart(WarmStart *ws);
+
+// Arc of the doubled graph (arcs 2i and 2i+1 of edge i) over which v is entered from its parent
+int parentArc(int v, WarmStart *ws, Graph *g);
+
+// To be called from the branch-and-cut callback, offers the tree once GLPK asks for heuristic solutions
+void offerWarmStart(glp_tree *tree, WarmStart *ws);
+
+#endif
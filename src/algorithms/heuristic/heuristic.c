@@ -1,10 +1,23 @@
 #include <stdlib.h>
 #include <float.h>
+#include <string.h>
+#include <omp.h>
 
 #include "heuristic.h"
-#include "../mst/prim.h"
+#include "../mst/mst.h"
 #include "../dijkstra/dijkstra.h"
 #include "../../structures/queue.h"
+#include "../../stats.h"
+
+// Per-thread state of Takahashi-Matsuyama runs, reset after each run
+typedef struct {
+	PathsData *pathsData;
+	int *treeVertices;
+	bool *isInTree;
+	int *treeEdgeIndices;
+	bool *edgesVisited;
+	int *notInclTerms;
+} TMWorkspace;
 
 static int collectEdgeIndices(int *mstIndices, int n, int *edgeIndices) {
 	int nEdges = 0;
@@ -18,7 +31,7 @@ static int collectEdgeIndices(int *mstIndices, int n, int *edgeIndices) {
 }
 
 SteinerTree prunedMST(Graph *g, Terminals *terms) {
-	int *mstIndices = prim(g, terms->vertices[0]); // Returns for each vertex the edge from the predecessor
+	int *mstIndices = minimumSpanningTree(g, terms->vertices[0]); // Returns for each vertex the edge from the predecessor
 
 	// Counting degrees in MST
 	int *degree = calloc(g->n, sizeof(int));
@@ -79,45 +92,80 @@ SteinerTree prunedMST(Graph *g, Terminals *terms) {
 }
 
 SteinerTree mstST(Graph *g, Terminals *terms) {
-	int *mstIndices = prim(g, terms->vertices[0]); // Returns for each vertex the edge from the predecessor
+	int *mstIndices = minimumSpanningTree(g, terms->vertices[0]); // Returns for each vertex the edge from the predecessor
 	int *selectedEdgeIndices = calloc(g->m, sizeof(int));
 	int nEdges = collectEdgeIndices(mstIndices, g->n, selectedEdgeIndices);
 	free(mstIndices);
 	return (SteinerTree){selectedEdgeIndices, nEdges};
 }
 
-SteinerTree takahashiMatsuyama(Graph *g, Terminals *terms) {
-	int *treeVertices = calloc(g->n, sizeof(int));
-	treeVertices[0] = terms->vertices[0];
-	int nTreeVertices = 1;
+static TMWorkspace *createTMWorkspace(Graph *g, Terminals *terms) {
+	TMWorkspace *ws = calloc(1, sizeof(TMWorkspace));
+	ws->pathsData = createPathsData(g->n);
+	ws->treeVertices = calloc(g->n, sizeof(int));
+	ws->isInTree = calloc(g->n, sizeof(bool));
+	ws->treeEdgeIndices = calloc(g->m, sizeof(int));
+	ws->edgesVisited = calloc(g->m, sizeof(bool));
+	ws->notInclTerms = calloc(terms->n, sizeof(int));
+	return ws;
+}
+
+static void freeTMWorkspace(TMWorkspace *ws) {
+	freePathsData(ws->pathsData);
+	free(ws->treeVertices);
+	free(ws->isInTree);
+	free(ws->treeEdgeIndices);
+	free(ws->edgesVisited);
+	free(ws->notInclTerms);
+	free(ws);
+}
 
-	bool *isInTree = calloc(g->n, sizeof(bool));
-	isInTree[terms->vertices[0]] = true;
+// Builds the tree from the terminal at rootI into the workspace and returns its number of edges.
+// Without isIncremental, every iteration searches from the whole tree again.
+static int runTakahashiMatsuyama(Graph *g, Terminals *terms, int rootI, bool isIncremental, TMWorkspace *ws) {
+	int *treeVertices = ws->treeVertices;
+	bool *isInTree = ws->isInTree;
+	int *treeEdgeIndices = ws->treeEdgeIndices;
+	bool *edgesVisited = ws->edgesVisited;
+	PathsData *pathsData = ws->pathsData;
 
-	int *treeEdgeIndices = calloc(g->m, sizeof(int));
+	int root = terms->vertices[rootI];
+	treeVertices[0] = root;
+	int nTreeVertices = 1;
+	isInTree[root] = true;
 	int nTreeEdges = 0;
-	
-	int nNotInclTerms = terms->n-1;
-	int *notInclTerms = calloc(nNotInclTerms, sizeof(int));
-	for (int i = 1; i < terms->n; i++) {
-		notInclTerms[i-1] = terms->vertices[i];
-	}
 
-	PathsData *pathsData = createPathsData(g->n);
-	bool *edgesVisited = calloc(g->m, sizeof(bool));
+	int nNotInclTerms = 0;
+	int *notInclTerms = ws->notInclTerms;
+	for (int i = 0; i < terms->n; i++) {
+		if (i != rootI) {
+			notInclTerms[nNotInclTerms] = terms->vertices[i];
+			nNotInclTerms++;
+		}
+	}
 
+	// Distances to the tree are kept between iterations, only the vertices added last become new sources
+	int nSearchedTreeVertices = 0;
 	while (nNotInclTerms > 0) {
 		double shortestDist = DBL_MAX;
 		int nearestTermI = -1;
 		int nearestTerm = -1;
 
-		multiDijkstra(treeVertices, nTreeVertices, pathsData, g);
+		double start = startPhase();
+		if (!isIncremental && nSearchedTreeVertices > 0) {
+			cleanPathsData(pathsData);
+			nSearchedTreeVertices = 0;
+		}
+		multiDijkstra(&treeVertices[nSearchedTreeVertices], nTreeVertices - nSearchedTreeVertices, pathsData, g);
+		nSearchedTreeVertices = nTreeVertices;
+		endPhase(PHASE_TM_SEARCH, start);
 	
 		// Find terminal not already in tree with shortest distance to tree
 		for (int i = 0; i < nNotInclTerms; i++) {
 			int notIncTerm = notInclTerms[i];
-			if (pathsData->dist[notIncTerm] < shortestDist) {
-				shortestDist = pathsData->dist[notIncTerm];
+			double dist = getDist(notIncTerm, pathsData);
+			if (dist < shortestDist) {
+				shortestDist = dist;
 				nearestTerm = notIncTerm;
 				nearestTermI = i;
 			}
@@ -131,6 +179,7 @@ SteinerTree takahashiMatsuyama(Graph *g, Terminals *terms) {
 		nNotInclTerms--;
 
 		// Add shortest path to tree
+		start = startPhase();
 		int vI = nearestTerm;
 		int eI = pathsData->preEdgeIndices[vI];
 		while (eI != -1) {
@@ -164,14 +213,106 @@ SteinerTree takahashiMatsuyama(Graph *g, Terminals *terms) {
 			vI = getPredecessor(vI, e);
 			eI = pathsData->preEdgeIndices[vI];
 		}
-		cleanPathsData(pathsData, g->n);
+		endPhase(PHASE_TM_ADD_PATH, start);
 	}
 
-	freePathsData(pathsData);
-	free(edgesVisited);
-	free(treeVertices);
-	free(notInclTerms);
-	free(isInTree);
+	// Reset the workspace for the next run
+	cleanPathsData(pathsData);
+	for (int i = 0; i < nTreeVertices; i++) {
+		isInTree[treeVertices[i]] = false;
+	}
+	for (int i = 0; i < nTreeEdges; i++) {
+		edgesVisited[treeEdgeIndices[i]] = false;
+	}
+	return nTreeEdges;
+}
 
+static SteinerTree copyTree(TMWorkspace *ws, int nTreeEdges) {
+	int *treeEdgeIndices = calloc(nTreeEdges + 1, sizeof(int));
+	memcpy(treeEdgeIndices, ws->treeEdgeIndices, nTreeEdges * sizeof(int));
 	return (SteinerTree){treeEdgeIndices, nTreeEdges};
 }
+
+SteinerTree takahashiMatsuyama(Graph *g, Terminals *terms) {
+	TMWorkspace *ws = createTMWorkspace(g, terms);
+	int nTreeEdges = runTakahashiMatsuyama(g, terms, 0, true, ws);
+	SteinerTree st = copyTree(ws, nTreeEdges);
+	freeTMWorkspace(ws);
+	return st;
+}
+
+SteinerTree recomputingTakahashiMatsuyama(Graph *g, Terminals *terms) {
+	TMWorkspace *ws = createTMWorkspace(g, terms);
+	int nTreeEdges = runTakahashiMatsuyama(g, terms, 0, false, ws);
+	SteinerTree st = copyTree(ws, nTreeEdges);
+	freeTMWorkspace(ws);
+	return st;
+}
+
+SteinerTree parallelTakahashiMatsuyama(Graph *g, Terminals *terms, double timeLimit) {
+	int nThreads = omp_get_max_threads();
+	double deadline = omp_get_wtime() + timeLimit;
+
+	// Without a time limit, every thread builds one tree. Otherwise, roots are tried until time is up.
+	int nRoots = (timeLimit > 0) ? terms->n : nThreads;
+	if (nRoots > terms->n) {
+		nRoots = terms->n;
+	}
+
+	TMWorkspace **workspaces = calloc(nThreads, sizeof(TMWorkspace*));
+	SteinerTree *bestTrees = calloc(nThreads, sizeof(SteinerTree));
+	double *bestCosts = calloc(nThreads, sizeof(double));
+	int *bestRoots = calloc(nThreads, sizeof(int));
+	for (int t = 0; t < nThreads; t++) {
+		bestCosts[t] = DBL_MAX;
+		bestRoots[t] = -1;
+	}
+
+	#pragma omp parallel for schedule(dynamic, 1)
+	for (int i = 0; i < nRoots; i++) {
+		int tID = omp_get_thread_num();
+		if (i > 0 && timeLimit > 0 && omp_get_wtime() > deadline) {
+			continue; // Tree from the first root is always built
+		}
+		if (workspaces[tID] == NULL) {
+			workspaces[tID] = createTMWorkspace(g, terms);
+		}
+		// Spread the roots over the terminal list
+		int rootI = (int)((long long)i * terms->n / nRoots);
+		int nTreeEdges = runTakahashiMatsuyama(g, terms, rootI, true, workspaces[tID]);
+		double cost = sumEdgeCosts(workspaces[tID]->treeEdgeIndices, nTreeEdges, g);
+
+		// Ties are broken by the smaller root index, so the result does not depend on the scheduling
+		if (cost < bestCosts[tID] || (cost == bestCosts[tID] && rootI < bestRoots[tID])) {
+			free(bestTrees[tID].treeEdgeIndices);
+			bestTrees[tID] = copyTree(workspaces[tID], nTreeEdges);
+			bestCosts[tID] = cost;
+			bestRoots[tID] = rootI;
+		}
+	}
+
+	int best = -1;
+	for (int t = 0; t < nThreads; t++) {
+		if (bestRoots[t] == -1) {
+			continue;
+		}
+		if (best == -1 || bestCosts[t] < bestCosts[best] || (bestCosts[t] == bestCosts[best] && bestRoots[t] < bestRoots[best])) {
+			best = t;
+		}
+	}
+	SteinerTree st = bestTrees[best];
+
+	for (int t = 0; t < nThreads; t++) {
+		if (t != best) {
+			free(bestTrees[t].treeEdgeIndices);
+		}
+		if (workspaces[t] != NULL) {
+			freeTMWorkspace(workspaces[t]);
+		}
+	}
+	free(workspaces);
+	free(bestTrees);
+	free(bestCosts);
+	free(bestRoots);
+	return st;
+}
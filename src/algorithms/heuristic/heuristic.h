@@ -10,4 +10,9 @@ SteinerTree mstST(Graph *g, Terminals *terms);
 
 SteinerTree takahashiMatsuyama(Graph *g, Terminals *terms);
 
+// Searches from the whole tree in every iteration instead of extending the previous search, reference for -t
+SteinerTree recomputingTakahashiMatsuyama(Graph *g, Terminals *terms);
+
+SteinerTree parallelTakahashiMatsuyama(Graph *g, Terminals *terms, double timeLimit);
+
 #endif
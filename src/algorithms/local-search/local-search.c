@@ -0,0 +1,777 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <omp.h>
+
+#include "local-search.h"
+#include "../dijkstra/dijkstra.h"
+#include "../../structures/buffer.h"
+#include "../../structures/union-find.h"
+#include "../../stats.h"
+
+#define IMPROVEMENT_EPS 1e-9 // Moves have to save more than this to be applied
+
+// Current tree and scratch space of the moves. A vertex is in the tree iff it is a terminal or has tree edges.
+typedef struct {
+	Graph *g;
+	bool *isTerminal;
+	bool *edgeInTree;
+	bool *inTree;
+	int *degree;
+	double cost;
+	int nMoves;
+	double deadline; // omp_get_wtime() after which no further moves are tried (DBL_MAX for none)
+
+	PathsData *pathsData;
+	bool *isMarked;
+	int *compOf; // Component of a vertex while a move has split the tree (-1 for none)
+
+	// Tree rooted at a terminal for the path queries of vertex insertions, only valid while isRooted
+	int root;
+	bool isRooted;
+	int *parentEdges;
+	int *depth;
+	int *preorder;
+	int *subtreeEnd; // Preorder number after the last vertex of the subtree
+	int *queue;
+	int *incident;
+	int *removedEdges;
+	int *addedEdges;
+	int *compVertices;
+	int *sources;
+	int *ops; // Log of edge insertions (edgeI) and removals (-edgeI-1) of a vertex insertion
+} LocalSearch;
+
+static LocalSearch *createLocalSearch(Graph *g, Terminals *terms, SteinerTree st, double timeLimit) {
+	LocalSearch *ls = calloc(1, sizeof(LocalSearch));
+	ls->g = g;
+	ls->isTerminal = calloc(g->n, sizeof(bool));
+	ls->edgeInTree = calloc(g->m, sizeof(bool));
+	ls->inTree = calloc(g->n, sizeof(bool));
+	ls->degree = calloc(g->n, sizeof(int));
+	ls->deadline = timeLimit > 0 ? omp_get_wtime() + timeLimit : DBL_MAX;
+
+	ls->pathsData = createPathsData(g->n);
+	ls->isMarked = calloc(g->n, sizeof(bool));
+	ls->compOf = calloc(g->n, sizeof(int));
+	ls->parentEdges = calloc(g->n, sizeof(int));
+	ls->depth = calloc(g->n, sizeof(int));
+	ls->preorder = calloc(g->n, sizeof(int));
+	ls->subtreeEnd = calloc(g->n, sizeof(int));
+	ls->queue = calloc(g->n, sizeof(int));
+	ls->incident = calloc(g->n, sizeof(int));
+	ls->removedEdges = calloc(g->n, sizeof(int));
+	ls->addedEdges = calloc(g->n, sizeof(int));
+	ls->compVertices = calloc(g->n, sizeof(int));
+	ls->sources = calloc(g->n, sizeof(int));
+	ls->ops = calloc(3*(size_t)g->n + 1, sizeof(int));
+
+	for (int v = 0; v < g->n; v++) {
+		ls->compOf[v] = -1;
+	}
+	ls->root = (terms->n > 0) ? terms->vertices[0] : 0;
+	for (int i = 0; i < terms->n; i++) {
+		ls->isTerminal[terms->vertices[i]] = true;
+		ls->inTree[terms->vertices[i]] = true;
+	}
+	for (int i = 0; i < st.n; i++) {
+		Edge e = g->edges[st.treeEdgeIndices[i]];
+		ls->edgeInTree[st.treeEdgeIndices[i]] = true;
+		ls->inTree[e.v] = true;
+		ls->inTree[e.w] = true;
+		ls->degree[e.v]++;
+		ls->degree[e.w]++;
+		ls->cost += e.cost;
+	}
+	return ls;
+}
+
+static void freeLocalSearch(LocalSearch *ls) {
+	free(ls->isTerminal);
+	free(ls->edgeInTree);
+	free(ls->inTree);
+	free(ls->degree);
+	freePathsData(ls->pathsData);
+	free(ls->isMarked);
+	free(ls->compOf);
+	free(ls->parentEdges);
+	free(ls->depth);
+	free(ls->preorder);
+	free(ls->subtreeEnd);
+	free(ls->queue);
+	free(ls->incident);
+	free(ls->removedEdges);
+	free(ls->addedEdges);
+	free(ls->compVertices);
+	free(ls->sources);
+	free(ls->ops);
+	free(ls);
+}
+
+static bool isTimeUp(LocalSearch *ls) {
+	return ls->deadline != DBL_MAX && omp_get_wtime() > ls->deadline;
+}
+
+static void addTreeEdge(int edgeI, LocalSearch *ls) {
+	Edge e = ls->g->edges[edgeI];
+	ls->edgeInTree[edgeI] = true;
+	ls->inTree[e.v] = true;
+	ls->inTree[e.w] = true;
+	ls->degree[e.v]++;
+	ls->degree[e.w]++;
+}
+
+static void removeTreeEdge(int edgeI, LocalSearch *ls) {
+	Edge e = ls->g->edges[edgeI];
+	ls->edgeInTree[edgeI] = false;
+	ls->degree[e.v]--;
+	ls->degree[e.w]--;
+	ls->inTree[e.v] = ls->isTerminal[e.v] || ls->degree[e.v] > 0;
+	ls->inTree[e.w] = ls->isTerminal[e.w] || ls->degree[e.w] > 0;
+}
+
+static void addTreeEdges(int *edges, int nEdges, LocalSearch *ls) {
+	for (int i = 0; i < nEdges; i++) {
+		addTreeEdge(edges[i], ls);
+	}
+}
+
+static void removeTreeEdges(int *edges, int nEdges, LocalSearch *ls) {
+	for (int i = 0; i < nEdges; i++) {
+		removeTreeEdge(edges[i], ls);
+	}
+}
+
+static double sumCosts(int *edges, int nEdges, Graph *g) {
+	double cost = 0;
+	for (int i = 0; i < nEdges; i++) {
+		cost += g->edges[edges[i]].cost;
+	}
+	return cost;
+}
+
+// Terminals and Steiner vertices of degree other than 2 end key paths
+static bool isKeyVertex(int v, LocalSearch *ls) {
+	return ls->isTerminal[v] || ls->degree[v] != 2;
+}
+
+static int collectTreeEdges(int v, LocalSearch *ls, int *edges) {
+	Graph *g = ls->g;
+	int nEdges = 0;
+	for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+		if (ls->edgeInTree[g->adjEdges[i]]) {
+			edges[nEdges] = g->adjEdges[i];
+			nEdges++;
+		}
+	}
+	return nEdges;
+}
+
+// Appends the key path that leaves key vertex u over tree edge edgeI to edges and returns its other key vertex
+static int walkKeyPath(int u, int edgeI, LocalSearch *ls, int *edges, int *nEdges) {
+	Graph *g = ls->g;
+	int v = u;
+	while (true) {
+		edges[*nEdges] = edgeI;
+		(*nEdges)++;
+		v = getPredecessor(v, g->edges[edgeI]);
+		if (isKeyVertex(v, ls)) {
+			return v;
+		}
+		// Continue over the other tree edge of the degree 2 Steiner vertex
+		for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+			if (ls->edgeInTree[g->adjEdges[i]] && g->adjEdges[i] != edgeI) {
+				edgeI = g->adjEdges[i];
+				break;
+			}
+		}
+	}
+}
+
+// Removes Steiner leaves starting at v, removals are appended to ops as -edgeI-1 if it is not NULL
+static double pruneFrom(int v, LocalSearch *ls, int *ops, int *nOps) {
+	Graph *g = ls->g;
+	double saved = 0;
+	while (!ls->isTerminal[v] && ls->degree[v] == 1) {
+		int edgeI = -1;
+		collectTreeEdges(v, ls, &edgeI);
+		removeTreeEdge(edgeI, ls);
+		saved += g->edges[edgeI].cost;
+		if (ops != NULL) {
+			ops[*nOps] = -edgeI-1;
+			(*nOps)++;
+		}
+		v = getPredecessor(v, g->edges[edgeI]);
+	}
+	return saved;
+}
+
+// Expands the next vertex of a breadth-first search over tree edges that labels a component.
+// Returns false once the component is complete.
+static bool expandComponent(int comp, LocalSearch *ls, int *vertices, int *nVertices, int *nExpanded) {
+	Graph *g = ls->g;
+	if (*nExpanded == *nVertices) {
+		return false;
+	}
+	int v = vertices[*nExpanded];
+	(*nExpanded)++;
+	for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+		int w = g->adjVertices[i];
+		if (ls->edgeInTree[g->adjEdges[i]] && ls->compOf[w] == -1) {
+			ls->compOf[w] = comp;
+			vertices[*nVertices] = w;
+			(*nVertices)++;
+		}
+	}
+	return true;
+}
+
+// Labels the tree component of start and appends its vertices to vertices
+static int collectComponent(int start, int comp, LocalSearch *ls, int *vertices) {
+	int nVertices = 1;
+	int nExpanded = 0;
+	vertices[0] = start;
+	ls->compOf[start] = comp;
+	while (expandComponent(comp, ls, vertices, &nVertices, &nExpanded));
+	return nVertices;
+}
+
+static void clearComponents(int *vertices, int nVertices, LocalSearch *ls) {
+	for (int k = 0; k < nVertices; k++) {
+		ls->compOf[vertices[k]] = -1;
+		ls->isMarked[vertices[k]] = false;
+	}
+}
+
+// Marked vertex outside of the source part with the smallest distance after a search stopped
+// at the first settled one
+static int findReachedMarked(bool *isMarked, int sourceComp, LocalSearch *ls) {
+	PathsData *pd = ls->pathsData;
+	int reached = -1;
+	for (int k = 0; k < pd->nTouched; k++) {
+		int v = pd->touched[k];
+		if (isMarked[v] && ls->compOf[v] != sourceComp && (reached == -1 || getDist(v, pd) < getDist(reached, pd))) {
+			reached = v;
+		}
+	}
+	return reached;
+}
+
+// Appends the edges of the shortest path from a source to v and the vertices on it
+static void tracePath(int v, LocalSearch *ls, int *edges, int *nEdges, int *vertices, int *nVertices) {
+	Graph *g = ls->g;
+	int edgeI = ls->pathsData->preEdgeIndices[v];
+	while (edgeI != -1) {
+		edges[*nEdges] = edgeI;
+		(*nEdges)++;
+		v = getPredecessor(v, g->edges[edgeI]);
+		if (vertices != NULL && ls->pathsData->preEdgeIndices[v] != -1) {
+			vertices[*nVertices] = v;
+			(*nVertices)++;
+		}
+		edgeI = ls->pathsData->preEdgeIndices[v];
+	}
+}
+
+// Replaces the key path from u over edgeI by a shorter path between the two parts of the tree
+static bool exchangeKeyPath(int u, int edgeI, LocalSearch *ls) {
+	int nPath = 0;
+	int w = walkKeyPath(u, edgeI, ls, ls->removedEdges, &nPath);
+	if (w < u) {
+		return false; // Handled from the other end
+	}
+	double pathCost = sumCosts(ls->removedEdges, nPath, ls->g);
+	if (pathCost <= IMPROVEMENT_EPS) {
+		return false;
+	}
+	removeTreeEdges(ls->removedEdges, nPath, ls);
+
+	// Label both parts in turns until the smaller one is complete, only that one is searched from
+	int nU = 1, nW = 1;
+	int nExpandedU = 0, nExpandedW = 0;
+	ls->sources[0] = u;
+	ls->compOf[u] = 0;
+	ls->compVertices[0] = w;
+	ls->compOf[w] = 1;
+	int sourceComp = 0;
+	while (expandComponent(0, ls, ls->sources, &nU, &nExpandedU)) {
+		if (!expandComponent(1, ls, ls->compVertices, &nW, &nExpandedW)) {
+			sourceComp = 1;
+			break;
+		}
+	}
+	int *sources = sourceComp == 0 ? ls->sources : ls->compVertices;
+	int nSources = sourceComp == 0 ? nU : nW;
+	int *others = sourceComp == 0 ? ls->compVertices : ls->sources;
+	int nOthers = sourceComp == 0 ? nW : nU;
+	clearComponents(others, nOthers, ls);
+
+	// All tree vertices are marked, so the search stops once all sources and one vertex of the other part are settled
+	SearchLimits limits = noSearchLimits();
+	limits.maxDist = pathCost - IMPROVEMENT_EPS;
+	limits.isMarked = ls->inTree;
+	limits.nMarked = nSources + 1;
+	limitedMultiDijkstra(sources, nSources, limits, ls->pathsData, ls->g);
+
+	int reached = findReachedMarked(ls->inTree, sourceComp, ls);
+	bool improved = reached != -1 && getDist(reached, ls->pathsData) < pathCost - IMPROVEMENT_EPS;
+	if (improved) {
+		int nAdded = 0;
+		tracePath(reached, ls, ls->addedEdges, &nAdded, NULL, NULL);
+		addTreeEdges(ls->addedEdges, nAdded, ls);
+		ls->cost -= pathCost - getDist(reached, ls->pathsData);
+	}
+	else {
+		addTreeEdges(ls->removedEdges, nPath, ls);
+	}
+	clearComponents(sources, nSources, ls);
+	cleanPathsData(ls->pathsData);
+	return improved;
+}
+
+// Removes Steiner vertex v with all its key paths and reconnects the parts like Takahashi-Matsuyama,
+// extending the search incrementally by every part and path that joins
+static bool eliminateKeyVertex(int v, LocalSearch *ls) {
+	Graph *g = ls->g;
+	int nIncident = collectTreeEdges(v, ls, ls->incident);
+	int nRemoved = 0;
+	int *ends = ls->queue;
+	for (int k = 0; k < nIncident; k++) {
+		ends[k] = walkKeyPath(v, ls->incident[k], ls, ls->removedEdges, &nRemoved);
+	}
+	double removedCost = sumCosts(ls->removedEdges, nRemoved, g);
+	removeTreeEdges(ls->removedEdges, nRemoved, ls);
+
+	// Parts are stored one after another in compVertices, part k starts at compStarts[k]
+	int *compStarts = calloc(nIncident + 1, sizeof(int));
+	for (int k = 0; k < nIncident; k++) {
+		compStarts[k+1] = compStarts[k] + collectComponent(ends[k], k, ls, &ls->compVertices[compStarts[k]]);
+	}
+	int nCompVertices = compStarts[nIncident];
+	for (int i = compStarts[1]; i < nCompVertices; i++) {
+		ls->isMarked[ls->compVertices[i]] = true;
+	}
+
+	int nAdded = 0;
+	double spent = 0;
+	int *sources = &ls->compVertices[0];
+	int nSources = compStarts[1];
+	bool connected = true;
+	for (int joined = 1; joined < nIncident; joined++) {
+		SearchLimits limits = noSearchLimits();
+		limits.maxDist = removedCost - spent - IMPROVEMENT_EPS;
+		limits.isMarked = ls->isMarked;
+		limits.nMarked = 1;
+		limitedMultiDijkstra(sources, nSources, limits, ls->pathsData, g);
+
+		int reached = findReachedMarked(ls->isMarked, 0, ls);
+		if (reached == -1 || getDist(reached, ls->pathsData) > limits.maxDist) {
+			connected = false;
+			break;
+		}
+		spent += getDist(reached, ls->pathsData);
+
+		// Path and reached part are the new sources, the previous distances stay valid
+		int comp = ls->compOf[reached];
+		nSources = 0;
+		sources = ls->sources;
+		tracePath(reached, ls, ls->addedEdges, &nAdded, sources, &nSources);
+		for (int i = compStarts[comp]; i < compStarts[comp+1]; i++) {
+			ls->isMarked[ls->compVertices[i]] = false;
+			sources[nSources] = ls->compVertices[i];
+			nSources++;
+		}
+	}
+
+	bool improved = connected && spent < removedCost - IMPROVEMENT_EPS;
+	if (improved) {
+		addTreeEdges(ls->addedEdges, nAdded, ls);
+		ls->cost -= removedCost - spent;
+	}
+	else {
+		addTreeEdges(ls->removedEdges, nRemoved, ls);
+	}
+	clearComponents(ls->compVertices, nCompVertices, ls);
+	cleanPathsData(ls->pathsData);
+	free(compStarts);
+	return improved;
+}
+
+static int comparePairValues(const void *a, const void *b) {
+	const Pair *p = a;
+	const Pair *q = b;
+	if (p->value != q->value) {
+		return p->value < q->value ? -1 : 1;
+	}
+	return p->key - q->key;
+}
+
+// Removes Steiner vertex v and reconnects its parts with an MST of the edges between tree vertices
+static bool eliminateSteinerVertex(int v, LocalSearch *ls) {
+	Graph *g = ls->g;
+	int nRemoved = collectTreeEdges(v, ls, ls->removedEdges);
+	double removedCost = sumCosts(ls->removedEdges, nRemoved, g);
+	removeTreeEdges(ls->removedEdges, nRemoved, ls);
+
+	int nCompVertices = 0;
+	for (int k = 0; k < nRemoved; k++) {
+		int u = getPredecessor(v, g->edges[ls->removedEdges[k]]);
+		nCompVertices += collectComponent(u, k, ls, &ls->compVertices[nCompVertices]);
+	}
+
+	// Candidate edges join two different parts
+	Buffer *candidates = createBuffer(sizeof(Pair));
+	for (int k = 0; k < nCompVertices; k++) {
+		int u = ls->compVertices[k];
+		for (int i = g->offsets[u]; i < g->offsets[u+1]; i++) {
+			int w = g->adjVertices[i];
+			if (u < w && ls->compOf[w] != -1 && ls->compOf[w] != ls->compOf[u]) {
+				Pair p = {g->adjEdges[i], getAdjCost(i, g)};
+				appendToBuffer(candidates, &p);
+			}
+		}
+	}
+	Pair *sorted = (Pair*)candidates->data;
+	qsort(sorted, candidates->n, sizeof(Pair), comparePairValues);
+
+	// Kruskal on the parts
+	UnionFind *uf = createUnionFind(nRemoved);
+	int nAdded = 0;
+	double spent = 0;
+	for (int i = 0; i < candidates->n && nAdded < nRemoved-1 && spent < removedCost; i++) {
+		Edge e = g->edges[sorted[i].key];
+		int compV = findSet(uf, ls->compOf[e.v]);
+		int compW = findSet(uf, ls->compOf[e.w]);
+		if (compV != compW) {
+			unionSet(uf, compV, compW);
+			ls->addedEdges[nAdded] = sorted[i].key;
+			nAdded++;
+			spent += e.cost;
+		}
+	}
+
+	bool improved = nAdded == nRemoved-1 && spent < removedCost - IMPROVEMENT_EPS;
+	if (improved) {
+		addTreeEdges(ls->addedEdges, nAdded, ls);
+		ls->cost -= removedCost - spent;
+		// Former neighbours that were passed through may be Steiner leaves now
+		for (int k = 0; k < nRemoved; k++) {
+			ls->cost -= pruneFrom(getPredecessor(v, g->edges[ls->removedEdges[k]]), ls, NULL, NULL);
+		}
+	}
+	else {
+		addTreeEdges(ls->removedEdges, nRemoved, ls);
+	}
+	clearComponents(ls->compVertices, nCompVertices, ls);
+	freeUnionFind(uf);
+	freeBuffer(candidates);
+	return improved;
+}
+
+static int treeParent(int v, LocalSearch *ls) {
+	return getPredecessor(v, ls->g->edges[ls->parentEdges[v]]);
+}
+
+// Roots the current tree at ls->root by a DFS, so that paths can be walked upwards
+static void rootTree(LocalSearch *ls) {
+	Graph *g = ls->g;
+	int *stack = ls->queue;
+	int *order = ls->sources;
+	int nStack = 1;
+	int nOrdered = 0;
+	stack[0] = ls->root;
+	ls->parentEdges[ls->root] = -1;
+	ls->depth[ls->root] = 0;
+	while (nStack > 0) {
+		int v = stack[--nStack];
+		ls->preorder[v] = nOrdered;
+		order[nOrdered] = v;
+		nOrdered++;
+		for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+			int edgeI = g->adjEdges[i];
+			if (ls->edgeInTree[edgeI] && edgeI != ls->parentEdges[v]) {
+				int w = g->adjVertices[i];
+				ls->parentEdges[w] = edgeI;
+				ls->depth[w] = ls->depth[v] + 1;
+				stack[nStack++] = w;
+			}
+		}
+	}
+	// Subtrees are contiguous in the preorder
+	for (int k = nOrdered-1; k >= 0; k--) {
+		int v = order[k];
+		ls->subtreeEnd[v] = ls->preorder[v] + 1;
+	}
+	for (int k = nOrdered-1; k > 0; k--) {
+		int v = order[k];
+		int parent = treeParent(v, ls);
+		if (ls->subtreeEnd[v] > ls->subtreeEnd[parent]) {
+			ls->subtreeEnd[parent] = ls->subtreeEnd[v];
+		}
+	}
+	ls->isRooted = true;
+}
+
+static bool isTreeAncestor(int a, int v, LocalSearch *ls) {
+	return ls->preorder[a] <= ls->preorder[v] && ls->preorder[v] < ls->subtreeEnd[a];
+}
+
+static int findTreeLCA(int u, int w, LocalSearch *ls) {
+	while (ls->depth[u] > ls->depth[w]) {
+		u = treeParent(u, ls);
+	}
+	while (ls->depth[w] > ls->depth[u]) {
+		w = treeParent(w, ls);
+	}
+	while (u != w) {
+		u = treeParent(u, ls);
+		w = treeParent(w, ls);
+	}
+	return u;
+}
+
+// Tree edge with the highest cost on the path from v up to its ancestor a
+static int findMaxEdgeUpTo(int v, int a, LocalSearch *ls) {
+	Graph *g = ls->g;
+	int maxEdgeI = -1;
+	for (; v != a; v = treeParent(v, ls)) {
+		int edgeI = ls->parentEdges[v];
+		if (maxEdgeI == -1 || g->edges[edgeI].cost > g->edges[maxEdgeI].cost) {
+			maxEdgeI = edgeI;
+		}
+	}
+	return maxEdgeI;
+}
+
+// Edge of the MST computation of a vertex insertion: an edge of the inserted vertex or a tree path between two
+// points, which only competes with its most expensive edge
+typedef struct {
+	int ends[2];
+	double cost;
+	int edgeI;
+	bool isTreePath;
+} InsertionEdge;
+
+static int compareInsertionEdges(const void *a, const void *b) {
+	const InsertionEdge *p = a;
+	const InsertionEdge *q = b;
+	if (p->cost != q->cost) {
+		return p->cost < q->cost ? -1 : 1;
+	}
+	return q->isTreePath - p->isTreePath; // Tree paths first, so an edge of equal cost does not replace them
+}
+
+static int findPoint(int v, Pair *points, int nPoints, LocalSearch *ls) {
+	int lo = 0;
+	int hi = nPoints - 1;
+	while (points[(lo + hi) / 2].key != v) {
+		if (points[(lo + hi) / 2].value < ls->preorder[v]) {
+			lo = (lo + hi) / 2 + 1;
+		}
+		else {
+			hi = (lo + hi) / 2 - 1;
+		}
+	}
+	return (lo + hi) / 2;
+}
+
+static void logAddEdge(int edgeI, LocalSearch *ls, int *nOps) {
+	addTreeEdge(edgeI, ls);
+	ls->ops[*nOps] = edgeI;
+	(*nOps)++;
+}
+
+static void logRemoveEdge(int edgeI, LocalSearch *ls, int *nOps) {
+	removeTreeEdge(edgeI, ls);
+	ls->ops[*nOps] = -edgeI-1;
+	(*nOps)++;
+}
+
+// Adds Steiner vertex v by updating the MST of the tree with the edges of v, then prunes Steiner leaves.
+// The MST is computed on the tree vertices at the edges of v and their branching points, connected by the
+// compressed tree paths between them.
+static bool insertSteinerVertex(int v, LocalSearch *ls) {
+	Graph *g = ls->g;
+	int nCandidates = 0;
+	for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+		nCandidates += ls->inTree[g->adjVertices[i]];
+	}
+	if (nCandidates < 2) {
+		return false; // Would only become a leaf
+	}
+	if (!ls->isRooted) {
+		rootTree(ls);
+	}
+
+	// Points sorted by preorder, the lowest common ancestors of neighbours in this order are the branching points
+	Pair *points = calloc(2*nCandidates, sizeof(Pair));
+	int nPoints = 0;
+	for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+		int u = g->adjVertices[i];
+		if (ls->inTree[u]) {
+			points[nPoints] = (Pair){u, ls->preorder[u]};
+			nPoints++;
+		}
+	}
+	qsort(points, nPoints, sizeof(Pair), comparePairValues);
+	for (int k = 0; k+1 < nCandidates; k++) {
+		int a = findTreeLCA(points[k].key, points[k+1].key, ls);
+		points[nPoints] = (Pair){a, ls->preorder[a]};
+		nPoints++;
+	}
+	qsort(points, nPoints, sizeof(Pair), comparePairValues);
+	int nUnique = 0;
+	for (int k = 0; k < nPoints; k++) {
+		if (nUnique == 0 || points[k].key != points[nUnique-1].key) {
+			points[nUnique] = points[k];
+			nUnique++;
+		}
+	}
+	nPoints = nUnique;
+
+	// Tree paths from each point to the closest point above it, then the edges of v (which is point nPoints)
+	InsertionEdge *edges = calloc(nPoints + nCandidates, sizeof(InsertionEdge));
+	int nEdges = 0;
+	int *stack = ls->queue;
+	int nStack = 0;
+	for (int k = 0; k < nPoints; k++) {
+		int u = points[k].key;
+		while (nStack > 0 && !isTreeAncestor(points[stack[nStack-1]].key, u, ls)) {
+			nStack--;
+		}
+		if (nStack > 0) {
+			int maxEdgeI = findMaxEdgeUpTo(u, points[stack[nStack-1]].key, ls);
+			edges[nEdges] = (InsertionEdge){{stack[nStack-1], k}, g->edges[maxEdgeI].cost, maxEdgeI, true};
+			nEdges++;
+		}
+		stack[nStack++] = k;
+	}
+	for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+		int u = g->adjVertices[i];
+		if (ls->inTree[u]) {
+			edges[nEdges] = (InsertionEdge){{nPoints, findPoint(u, points, nPoints, ls)}, getAdjCost(i, g), g->adjEdges[i], false};
+			nEdges++;
+		}
+	}
+	qsort(edges, nEdges, sizeof(InsertionEdge), compareInsertionEdges);
+
+	// Kruskal, a tree path that closes a cycle loses its most expensive edge
+	UnionFind *uf = createUnionFind(nPoints + 1);
+	bool *isKept = calloc(nEdges, sizeof(bool));
+	for (int k = 0; k < nEdges; k++) {
+		isKept[k] = findSet(uf, edges[k].ends[0]) != findSet(uf, edges[k].ends[1]);
+		if (isKept[k]) {
+			unionSet(uf, edges[k].ends[0], edges[k].ends[1]);
+		}
+	}
+	int nOps = 0;
+	double gain = 0;
+	for (int k = 0; k < nEdges; k++) {
+		if (isKept[k] && !edges[k].isTreePath) {
+			gain -= edges[k].cost;
+			logAddEdge(edges[k].edgeI, ls, &nOps);
+		}
+	}
+	for (int k = 0; k < nEdges; k++) {
+		if (!isKept[k] && edges[k].isTreePath) {
+			gain += edges[k].cost;
+			logRemoveEdge(edges[k].edgeI, ls, &nOps);
+		}
+	}
+	freeUnionFind(uf);
+	free(isKept);
+	free(edges);
+	free(points);
+
+	int nSwapOps = nOps;
+	for (int k = 0; k < nSwapOps; k++) {
+		if (ls->ops[k] < 0) {
+			Edge e = g->edges[-ls->ops[k]-1];
+			gain += pruneFrom(e.v, ls, ls->ops, &nOps);
+			gain += pruneFrom(e.w, ls, ls->ops, &nOps);
+		}
+	}
+
+	bool improved = gain > IMPROVEMENT_EPS;
+	if (improved) {
+		ls->cost -= gain;
+		ls->isRooted = false;
+	}
+	else {
+		for (int k = nOps-1; k >= 0; k--) {
+			if (ls->ops[k] >= 0) {
+				removeTreeEdge(ls->ops[k], ls);
+			}
+			else {
+				addTreeEdge(-ls->ops[k]-1, ls);
+			}
+		}
+	}
+	return improved;
+}
+
+// One round over all vertices for each kind of move, returns whether any move was applied
+static bool runMoves(LocalSearch *ls) {
+	Graph *g = ls->g;
+	int nMovesBefore = ls->nMoves;
+
+	for (int v = 0; v < g->n && !isTimeUp(ls); v++) {
+		// Degree 2 Steiner vertices are covered by the key-path exchange
+		if (!ls->isTerminal[v] && ls->degree[v] >= 3 && eliminateSteinerVertex(v, ls)) {
+			ls->nMoves++;
+		}
+	}
+	ls->isRooted = false; // The tree is rooted again on the first insertion and after each applied one
+	for (int v = 0; v < g->n && !isTimeUp(ls); v++) {
+		if (!ls->inTree[v] && insertSteinerVertex(v, ls)) {
+			ls->nMoves++;
+		}
+	}
+	for (int u = 0; u < g->n && !isTimeUp(ls); u++) {
+		if (!ls->inTree[u] || !isKeyVertex(u, ls)) {
+			continue;
+		}
+		// Exchanges change the edges around u, so the key paths to try are fixed first
+		int *incident = calloc(ls->degree[u] + 1, sizeof(int));
+		int nIncident = collectTreeEdges(u, ls, incident);
+		for (int k = 0; k < nIncident && !isTimeUp(ls); k++) {
+			if (ls->edgeInTree[incident[k]] && isKeyVertex(u, ls) && exchangeKeyPath(u, incident[k], ls)) {
+				ls->nMoves++;
+			}
+		}
+		free(incident);
+	}
+	for (int v = 0; v < g->n && !isTimeUp(ls); v++) {
+		if (!ls->isTerminal[v] && ls->degree[v] >= 3 && eliminateKeyVertex(v, ls)) {
+			ls->nMoves++;
+		}
+	}
+	return ls->nMoves > nMovesBefore;
+}
+
+SteinerTree localSearch(Graph *g, Terminals *terms, SteinerTree st, double timeLimit) {
+	LocalSearch *ls = createLocalSearch(g, terms, st, timeLimit);
+
+	// Moves assume that all leaves are terminals
+	for (int v = 0; v < g->n; v++) {
+		ls->cost -= pruneFrom(v, ls, NULL, NULL);
+	}
+	int nRounds = 0;
+	while (!isTimeUp(ls) && runMoves(ls)) {
+		nRounds++;
+	}
+
+	int *treeEdgeIndices = calloc(g->n, sizeof(int));
+	int nTreeEdges = 0;
+	for (int i = 0; i < g->m; i++) {
+		if (ls->edgeInTree[i]) {
+			treeEdgeIndices[nTreeEdges] = i;
+			nTreeEdges++;
+		}
+	}
+	addCount(COUNT_LOCAL_SEARCH_MOVES, ls->nMoves);
+	addCount(COUNT_LOCAL_SEARCH_ROUNDS, nRounds);
+
+	freeLocalSearch(ls);
+	return (SteinerTree){treeEdgeIndices, nTreeEdges};
+}
@@ -0,0 +1,12 @@
+#ifndef LOCALSEARCH_H
+#define LOCALSEARCH_H
+
+#include "../../structures/graph.h"
+#include "../../utils.h"
+
+// Improves a Steiner tree by Steiner vertex elimination and insertion, key-path exchange and
+// key-vertex elimination until no move improves the cost or timeLimit seconds passed (0 for no limit).
+// Returns a new tree, st is left unchanged.
+SteinerTree localSearch(Graph *g, Terminals *terms, SteinerTree st, double timeLimit);
+
+#endif
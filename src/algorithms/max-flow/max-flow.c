@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <float.h>
+
+#include "max-flow.h"
+
+#define FLOW_EPS 1e-9 // Residual capacities below are treated as saturated
+
+MaxFlow *createMaxFlow(Graph *arcs) {
+	MaxFlow *mf = calloc(1, sizeof(MaxFlow));
+	mf->arcs = arcs;
+	mf->flow = calloc(arcs->m, sizeof(double));
+	mf->level = calloc(arcs->n, sizeof(int));
+	mf->nextAdj = calloc(arcs->n, sizeof(int));
+	mf->queue = calloc(arcs->n, sizeof(int));
+	mf->pathVertices = calloc(arcs->n, sizeof(int));
+	mf->pathArcs = calloc(arcs->n, sizeof(int));
+	return mf;
+}
+
+void freeMaxFlow(MaxFlow *mf) {
+	free(mf->flow);
+	free(mf->level);
+	free(mf->nextAdj);
+	free(mf->queue);
+	free(mf->pathVertices);
+	free(mf->pathArcs);
+	free(mf);
+}
+
+// Residual capacity of the adjacency entry at position i of u, i.e. forwards along an arc out of u
+// or backwards along an arc into u
+static double residual(int u, int i, double *capacities, MaxFlow *mf) {
+	int a = mf->arcs->adjEdges[i];
+	if (mf->arcs->edges[a].v == u) {
+		return capacities[a] - mf->flow[a];
+	}
+	return mf->flow[a];
+}
+
+// Breadth-first search in the residual graph, returns whether t is reached
+static bool buildLevels(int s, int t, double *capacities, MaxFlow *mf) {
+	Graph *g = mf->arcs;
+	for (int v = 0; v < g->n; v++) {
+		mf->level[v] = -1;
+	}
+	mf->level[s] = 0;
+	mf->queue[0] = s;
+	int nQueued = 1;
+	for (int k = 0; k < nQueued; k++) {
+		int u = mf->queue[k];
+		for (int i = g->offsets[u]; i < g->offsets[u+1]; i++) {
+			int w = g->adjVertices[i];
+			if (mf->level[w] == -1 && residual(u, i, capacities, mf) > FLOW_EPS) {
+				mf->level[w] = mf->level[u] + 1;
+				mf->queue[nQueued] = w;
+				nQueued++;
+			}
+		}
+	}
+	return mf->level[t] != -1;
+}
+
+// Pushes the bottleneck capacity along the path of adjacency positions from s
+static double augmentPath(int s, int nPath, double *capacities, MaxFlow *mf) {
+	Graph *g = mf->arcs;
+	double bottleneck = DBL_MAX;
+	int u = s;
+	for (int k = 0; k < nPath; k++) {
+		int i = mf->pathArcs[k];
+		double res = residual(u, i, capacities, mf);
+		if (res < bottleneck) {
+			bottleneck = res;
+		}
+		u = g->adjVertices[i];
+	}
+	u = s;
+	for (int k = 0; k < nPath; k++) {
+		int i = mf->pathArcs[k];
+		int a = g->adjEdges[i];
+		if (g->edges[a].v == u) {
+			mf->flow[a] += bottleneck;
+		}
+		else {
+			mf->flow[a] -= bottleneck; // Cancel flow of the opposite direction
+		}
+		u = g->adjVertices[i];
+	}
+	return bottleneck;
+}
+
+// Blocking flow in the level graph with an explicit path stack instead of recursion
+static double blockingFlow(int s, int t, double *capacities, double limit, MaxFlow *mf) {
+	Graph *g = mf->arcs;
+	for (int v = 0; v < g->n; v++) {
+		mf->nextAdj[v] = g->offsets[v];
+	}
+	double total = 0;
+	int nPath = 0;
+	int u = s;
+	while (total < limit) {
+		if (u == t) {
+			total += augmentPath(s, nPath, capacities, mf);
+			nPath = 0;
+			u = s;
+			continue;
+		}
+		// Advance along the next admissible position of u
+		bool advanced = false;
+		for (; mf->nextAdj[u] < g->offsets[u+1]; mf->nextAdj[u]++) {
+			int i = mf->nextAdj[u];
+			int w = g->adjVertices[i];
+			if (mf->level[w] == mf->level[u] + 1 && residual(u, i, capacities, mf) > FLOW_EPS) {
+				mf->pathVertices[nPath] = u;
+				mf->pathArcs[nPath] = i;
+				nPath++;
+				u = w;
+				advanced = true;
+				break;
+			}
+		}
+		if (advanced) {
+			continue;
+		}
+		// Dead end: remove u from the level graph and retreat
+		if (u == s) {
+			break;
+		}
+		mf->level[u] = -1;
+		nPath--;
+		u = mf->pathVertices[nPath];
+	}
+	return total;
+}
+
+double computeMaxFlow(int s, int t, double *capacities, double limit, MaxFlow *mf) {
+	for (int a = 0; a < mf->arcs->m; a++) {
+		mf->flow[a] = 0;
+	}
+	double total = 0;
+	while (total < limit && buildLevels(s, t, capacities, mf)) {
+		total += blockingFlow(s, t, capacities, limit - total, mf);
+	}
+	return total;
+}
+
+bool isOnSourceSide(int v, MaxFlow *mf) {
+	return mf->level[v] != -1;
+}
@@ -0,0 +1,30 @@
+#ifndef MAXFLOW_H
+#define MAXFLOW_H
+
+#include <stdbool.h>
+
+#include "../../structures/graph.h"
+
+// Reusable workspace of Dinic's algorithm on a graph of arcs (edges[a] leads from v to w)
+typedef struct {
+	Graph *arcs;
+	double *flow;
+	int *level;
+	int *nextAdj; // Next adjacency position to try per vertex in the blocking flow
+	int *queue;
+	int *pathVertices; // Path of the blocking flow: vertices and the adjacency positions taken from them
+	int *pathArcs;
+} MaxFlow;
+
+MaxFlow *createMaxFlow(Graph *arcs);
+
+void freeMaxFlow(MaxFlow *mf);
+
+// Maximum flow from s to t with the given arc capacities. Stops as soon as the flow reaches limit.
+double computeMaxFlow(int s, int t, double *capacities, double limit, MaxFlow *mf);
+
+// Whether v is reachable from s in the residual graph of the last flow, i.e. on the source side of a minimum cut.
+// Only valid if the last flow stayed below its limit.
+bool isOnSourceSide(int v, MaxFlow *mf);
+
+#endif
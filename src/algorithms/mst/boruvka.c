@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <omp.h>
+
+#include "boruvka.h"
+#include "mst.h"
+#include "../../structures/union-find.h"
+
+// Edges are ordered by cost and then by index, so all components agree on the cheapest edges and no cycle can form
+static bool isCheaper(int i, int j, Graph *g) {
+	if (j == -1) {
+		return true;
+	}
+	double costI = g->edges[i].cost;
+	double costJ = g->edges[j].cost;
+	return costI < costJ || (costI == costJ && i < j);
+}
+
+static int findRoot(int v, UnionFind *uf) {
+	// No path compression, so threads can look up roots concurrently
+	while (uf->parent[v] != v) {
+		v = uf->parent[v];
+	}
+	return v;
+}
+
+int *boruvka(Graph *g, int root) {
+	UnionFind *uf = createUnionFind(g->n);
+	int *components = calloc(g->n, sizeof(int));
+	int *cheapestOfVertex = calloc(g->n, sizeof(int));
+	int *cheapestOfComponent = calloc(g->n, sizeof(int));
+	bool *inMST = calloc(g->m + 1, sizeof(bool));
+	for (int v = 0; v < g->n; v++) {
+		components[v] = v;
+		cheapestOfComponent[v] = -1;
+	}
+
+	bool merged = true;
+	while (merged) {
+		merged = false;
+
+		// Cheapest edge leaving the component, searched from every vertex in parallel
+		#pragma omp parallel for schedule(dynamic, 1024)
+		for (int v = 0; v < g->n; v++) {
+			int cheapest = -1;
+			for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+				int edgeI = g->adjEdges[i];
+				if (components[g->adjVertices[i]] != components[v] && isCheaper(edgeI, cheapest, g)) {
+					cheapest = edgeI;
+				}
+			}
+			cheapestOfVertex[v] = cheapest;
+		}
+
+		for (int v = 0; v < g->n; v++) {
+			int c = components[v];
+			if (cheapestOfVertex[v] != -1 && isCheaper(cheapestOfVertex[v], cheapestOfComponent[c], g)) {
+				cheapestOfComponent[c] = cheapestOfVertex[v];
+			}
+		}
+
+		// Contract along the cheapest edges
+		for (int c = 0; c < g->n; c++) {
+			int edgeI = cheapestOfComponent[c];
+			if (edgeI == -1) {
+				continue;
+			}
+			cheapestOfComponent[c] = -1;
+			Edge e = g->edges[edgeI];
+			if (findSet(uf, e.v) != findSet(uf, e.w)) {
+				unionSet(uf, e.v, e.w);
+				inMST[edgeI] = true;
+				merged = true;
+			}
+		}
+
+		#pragma omp parallel for
+		for (int v = 0; v < g->n; v++) {
+			components[v] = findRoot(v, uf);
+		}
+	}
+
+	int *preEdgeIndices = orientSpanningTree(inMST, root, g);
+
+	free(inMST);
+	free(cheapestOfComponent);
+	free(cheapestOfVertex);
+	free(components);
+	freeUnionFind(uf);
+	return preEdgeIndices;
+}
@@ -0,0 +1,8 @@
+#ifndef BORUVKA_H
+#define BORUVKA_H
+
+#include "../../structures/graph.h"
+
+int *boruvka(Graph *g, int root);
+
+#endif
@@ -0,0 +1,44 @@
+#include <stdlib.h>
+#include <float.h>
+#include <stdbool.h>
+
+#include "dense-prim.h"
+
+int *densePrim(DistanceMatrix *dm, int root) {
+	int n = dm->n;
+	int *pred = calloc(n, sizeof(int));
+	double *key = calloc(n, sizeof(double));
+	bool *inTree = calloc(n, sizeof(bool));
+	for (int v = 0; v < n; v++) {
+		pred[v] = -1;
+		key[v] = DBL_MAX;
+	}
+
+	int v = root;
+	for (int k = 0; k < n && v != -1; k++) {
+		inTree[v] = true;
+
+		// Update keys with the distances from v and select the closest point outside the tree
+		int next = -1;
+		double nextKey = DBL_MAX;
+		for (int w = 0; w < n; w++) {
+			if (inTree[w]) {
+				continue;
+			}
+			double d = getDistance(v, w, dm);
+			if (d < key[w]) {
+				key[w] = d;
+				pred[w] = v;
+			}
+			if (key[w] < nextKey) {
+				nextKey = key[w];
+				next = w;
+			}
+		}
+		v = next; // No next point if the rest is unreachable
+	}
+
+	free(key);
+	free(inTree);
+	return pred;
+}
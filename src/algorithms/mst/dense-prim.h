@@ -0,0 +1,10 @@
+#ifndef DENSEPRIM_H
+#define DENSEPRIM_H
+
+#include "../../structures/distance-matrix.h"
+
+// Array-based Prim in O(n^2) for complete graphs given as distance matrix.
+// Returns for each point its predecessor point towards root (-1 for root and unreachable points).
+int *densePrim(DistanceMatrix *dm, int root);
+
+#endif
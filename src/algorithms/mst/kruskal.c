@@ -0,0 +1,99 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <omp.h>
+
+#include "kruskal.h"
+#include "mst.h"
+#include "../../structures/union-find.h"
+
+#define PARALLEL_SORT_MIN_RUN (1 << 15) // Smaller runs are sorted faster by one thread
+
+static int comparePairs(const void *a, const void *b) {
+	const Pair *p = a;
+	const Pair *q = b;
+	if (p->value != q->value) {
+		return (p->value > q->value) - (p->value < q->value);
+	}
+	return (p->key > q->key) - (p->key < q->key);
+}
+
+static void mergeRuns(Pair *src, int start, int mid, int end, Pair *dst) {
+	int i = start;
+	int j = mid;
+	for (int k = start; k < end; k++) {
+		if (j >= end || (i < mid && comparePairs(&src[i], &src[j]) <= 0)) {
+			dst[k] = src[i++];
+		}
+		else {
+			dst[k] = src[j++];
+		}
+	}
+}
+
+Pair *sortEdgesByCost(Graph *g) {
+	Pair *sorted = calloc(g->m + 1, sizeof(Pair));
+	for (int i = 0; i < g->m; i++) {
+		sorted[i] = (Pair){i, g->edges[i].cost};
+	}
+
+	int nRuns = omp_get_max_threads();
+	if (nRuns > g->m / PARALLEL_SORT_MIN_RUN) {
+		nRuns = g->m / PARALLEL_SORT_MIN_RUN;
+	}
+	if (nRuns <= 1) {
+		qsort(sorted, g->m, sizeof(Pair), comparePairs);
+		return sorted;
+	}
+
+	// Sort one run per thread, then merge neighboring runs level by level
+	int *starts = calloc(nRuns + 1, sizeof(int));
+	for (int r = 0; r <= nRuns; r++) {
+		starts[r] = (int)((long long)g->m * r / nRuns);
+	}
+	#pragma omp parallel for num_threads(nRuns)
+	for (int r = 0; r < nRuns; r++) {
+		qsort(&sorted[starts[r]], starts[r+1] - starts[r], sizeof(Pair), comparePairs);
+	}
+
+	Pair *tmp = calloc(g->m + 1, sizeof(Pair));
+	for (int width = 1; width < nRuns; width *= 2) {
+		#pragma omp parallel for
+		for (int r = 0; r < nRuns; r += 2 * width) {
+			int mid = (r + width < nRuns) ? r + width : nRuns;
+			int end = (r + 2 * width < nRuns) ? r + 2 * width : nRuns;
+			mergeRuns(sorted, starts[r], starts[mid], starts[end], tmp);
+		}
+		Pair *swap = sorted;
+		sorted = tmp;
+		tmp = swap;
+	}
+
+	free(tmp);
+	free(starts);
+	return sorted;
+}
+
+int *kruskal(Graph *g, int root) {
+	Pair *sorted = sortEdgesByCost(g);
+	UnionFind *uf = createUnionFind(g->n);
+	bool *inMST = calloc(g->m + 1, sizeof(bool));
+
+	int nMSTEdges = 0;
+	for (int k = 0; k < g->m && nMSTEdges < g->n - 1; k++) {
+		int edgeI = sorted[k].key;
+		Edge e = g->edges[edgeI];
+		if (findSet(uf, e.v) != findSet(uf, e.w)) {
+			unionSet(uf, e.v, e.w);
+			inMST[edgeI] = true;
+			nMSTEdges++;
+		}
+	}
+
+	int *preEdgeIndices = orientSpanningTree(inMST, root, g);
+
+	free(inMST);
+	freeUnionFind(uf);
+	free(sorted);
+	return preEdgeIndices;
+}
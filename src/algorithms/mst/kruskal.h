@@ -0,0 +1,12 @@
+#ifndef KRUSKAL_H
+#define KRUSKAL_H
+
+#include "../../structures/graph.h"
+#include "../../structures/prio-queue.h"
+
+// Edges as (edge index, cost) pairs ordered by cost and then by index
+Pair *sortEdgesByCost(Graph *g);
+
+int *kruskal(Graph *g, int root);
+
+#endif
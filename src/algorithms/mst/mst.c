@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <omp.h>
+
+#include "mst.h"
+#include "prim.h"
+#include "kruskal.h"
+#include "boruvka.h"
+#include "../../structures/queue.h"
+#include "../../utils.h"
+
+#define PARALLEL_MST_MIN_EDGES (1 << 20) // Boruvka only pays off with enough edges per thread
+#define PARALLEL_SORT_MIN_EDGES (1 << 16)
+#define SPARSE_MAX_EDGES_PER_VERTEX 4
+
+int *minimumSpanningTree(Graph *g, int root) {
+	// On a single thread, Prim with the indexed heap beats both alternatives for all densities
+	if (omp_get_max_threads() == 1) {
+		return prim(g, root);
+	}
+	if (g->m >= PARALLEL_MST_MIN_EDGES) {
+		return boruvka(g, root);
+	}
+	// Sparse graphs are dominated by sorting the edges, which runs in parallel for Kruskal
+	if (g->m >= PARALLEL_SORT_MIN_EDGES && g->m <= (long long)SPARSE_MAX_EDGES_PER_VERTEX * g->n) {
+		return kruskal(g, root);
+	}
+	return prim(g, root);
+}
+
+int *orientSpanningTree(bool *selectedEdges, int root, Graph *g) {
+	int *preEdgeIndices = calloc(g->n, sizeof(int));
+	bool *visited = calloc(g->n, sizeof(bool));
+	for (int v = 0; v < g->n; v++) {
+		preEdgeIndices[v] = -1;
+	}
+
+	// Breadth-first search from root over the selected edges
+	Queue *q = createQueue(g->n + 1);
+	enqueue(root, q);
+	visited[root] = true;
+	while (!isEmptyQueue(q)) {
+		int v = dequeue(q);
+		for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+			int w = g->adjVertices[i];
+			int edgeI = g->adjEdges[i];
+			if (selectedEdges[edgeI] && !visited[w]) {
+				visited[w] = true;
+				preEdgeIndices[w] = edgeI;
+				enqueue(w, q);
+			}
+		}
+	}
+
+	freeQueue(q);
+	free(visited);
+	return preEdgeIndices;
+}
@@ -0,0 +1,17 @@
+#ifndef MST_H
+#define MST_H
+
+#include <stdbool.h>
+
+#include "../../structures/graph.h"
+
+// All MST routines return for each vertex the edge to its predecessor on the path to root
+// (-1 for root and for vertices that are not connected to root).
+
+// Chooses Prim, Kruskal or parallel Boruvka depending on the size and density of g
+int *minimumSpanningTree(Graph *g, int root);
+
+// Turns a set of spanning tree edges into predecessor edges towards root
+int *orientSpanningTree(bool *selectedEdges, int root, Graph *g);
+
+#endif
@@ -0,0 +1,55 @@
+// Main loop of prim, included by prim.c once per cost type and queue.
+// Expects KERNEL_NAME, COST_TYPE and COSTS (cost array of the adjacency, also the type of the keys of the vertices),
+// COST_INF, QUEUE (member of SearchQueue), QUEUE_VALUE and its operations PUSH, POP and IS_EMPTY.
+// No include guard on purpose.
+
+static void KERNEL_NAME(int root, SearchQueue *pq, bool *inPQ, int *preEdgeIndices, Graph *g) {
+	const COST_TYPE *costs = g->COSTS;
+	COST_TYPE *dist = calloc(g->n, sizeof(COST_TYPE));
+	for (int i = 0; i < g->n; i++) {
+		dist[i] = COST_INF;
+	}
+	dist[root] = 0;
+	PUSH(root, 0, pq->QUEUE);
+	long nPushes = 1;
+	long nPops = 0;
+	long nRelaxed = 0;
+
+	// Create MST
+	while (!IS_EMPTY(pq->QUEUE)) {
+		QUEUE_VALUE value;
+		int v = POP(pq->QUEUE, &value);
+		nPops++;
+		
+		if (!inPQ[v]) {
+			continue;
+		}
+		inPQ[v] = false;
+
+		// Update keys of neighborhood
+		nRelaxed += g->offsets[v+1] - g->offsets[v];
+		for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+			int w = g->adjVertices[i];
+			COST_TYPE cost = costs[i];
+
+			if (inPQ[w] && cost < dist[w]) {
+				dist[w] = cost;
+				preEdgeIndices[w] = g->adjEdges[i];
+				PUSH(w, cost, pq->QUEUE);
+				nPushes++;
+			}
+		}
+	}
+	countSearch(false, nPushes, nPops, nRelaxed);
+	free(dist);
+}
+
+#undef KERNEL_NAME
+#undef COST_TYPE
+#undef COSTS
+#undef COST_INF
+#undef QUEUE
+#undef QUEUE_VALUE
+#undef PUSH
+#undef POP
+#undef IS_EMPTY
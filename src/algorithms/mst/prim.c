@@ -1,53 +1,73 @@
 #include <stdlib.h>
 #include <float.h>
+#include <limits.h>
 #include <stdbool.h>
 
 #include "prim.h"
-#include "../../structures/prio-queue.h"
+#include "../../structures/search-queue.h"
 #include "../../utils.h"
+#include "../../stats.h"
+
+// Kernels per cost type and queue, the queue is chosen by prepareSearchQueue from the costs of the graph
+
+#define KERNEL_NAME primIntBuckets
+#define COST_TYPE int
+#define COSTS adjIntCosts
+#define COST_INF INT_MAX
+#define QUEUE buckets
+#define QUEUE_VALUE unsigned long long
+#define PUSH pushBucketQueue
+#define POP extractMinBucketQueue
+#define IS_EMPTY isEmptyBucketQueue
+#include "prim-kernel.h"
+
+#define KERNEL_NAME primIntHeap
+#define COST_TYPE int
+#define COSTS adjIntCosts
+#define COST_INF INT_MAX
+#define QUEUE heap
+#define QUEUE_VALUE double
+#define PUSH pushHeapQueue
+#define POP popHeapQueue
+#define IS_EMPTY isEmptyHeapQueue
+#include "prim-kernel.h"
+
+#define KERNEL_NAME primRealHeap
+#define COST_TYPE double
+#define COSTS adjCosts
+#define COST_INF DBL_MAX
+#define QUEUE heap
+#define QUEUE_VALUE double
+#define PUSH pushHeapQueue
+#define POP popHeapQueue
+#define IS_EMPTY isEmptyHeapQueue
+#include "prim-kernel.h"
 
 int *prim(Graph *g, int root) {
-	PrioQueue *pq = createPrioQueue(g->n);
-	double *dist = calloc(g->n, sizeof(double));
+	SearchQueue *pq = createSearchQueue(g->n);
+	prepareSearchQueue(pq, g, false);
 	int *preEdgeIndices = calloc(g->n, sizeof(int));
 	for (int i = 0; i < g->n; i++) {
 		preEdgeIndices[i] = -1; // Init all indices to no valid value (representing NULL)
 	}
 	bool *inPQ = calloc(g->n, sizeof(bool));
 
-	// Init priority-queue and distances
+	// Init priority-queue
 	for (int i = 0; i < g->n; i++) {
-		dist[i] = DBL_MAX;
 		inPQ[i] = true;
 	}
-	dist[root] = 0;
-	insert((Pair){root, 0}, pq);
-
-	// Create MST
-	while (!isEmpty(pq)) {
-		Pair v = extractMin(pq);
-		
-		if (!inPQ[v.key]) {
-			continue;
-		}
-		inPQ[v.key] = false;
-
-		// Update keys of neighborhood
-		for (int i = 0; i < g->vertices[v.key].deg; i++) {
-			Edge *e = getEdge(v.key, i, g);
-			int w = getPredecessor(v.key, *e);
-			double cost = e->cost;
-
-			if (inPQ[w] && cost < dist[w]) {
-				dist[w] = cost;
-				preEdgeIndices[w] = getEdgeIndex(v.key, i, g);
-				insert((Pair){w, cost}, pq);
-			}
-		}
+
+	if (pq->kind == BUCKET_QUEUE) { // Only for small integer costs
+		primIntBuckets(root, pq, inPQ, preEdgeIndices, g);
+	}
+	else if (g->adjIntCosts != NULL) {
+		primIntHeap(root, pq, inPQ, preEdgeIndices, g);
+	}
+	else {
+		primRealHeap(root, pq, inPQ, preEdgeIndices, g);
 	}
 
-	freePrioQueue(pq);
-	free(dist);
+	freeSearchQueue(pq);
 	free(inPQ);
 	return preEdgeIndices;
 }
@@ -6,9 +6,13 @@
 #include <omp.h>
 
 #include "two-apx.h"
-#include "../mst/prim.h"
+#include "../mst/mst.h"
+#include "../mst/dense-prim.h"
 #include "../dijkstra/dijkstra.h"
 #include "../../structures/buffer.h"
+#include "../../structures/atomic-bitset.h"
+#include "../../structures/distance-matrix.h"
+#include "../../stats.h"
 
 static int addEdgeToEdges(int edgeI, int *edges, int nEdges, bool *edgesVisited) {
 	if (edgeI != -1 && !edgesVisited[edgeI]) {
@@ -34,72 +38,158 @@ static void clearFlags(int *edgeIndices, int nEdges, bool *visitedEdges) {
 	}
 }
 
-Graph *createMetricClosure(Graph *g, Terminals *terms) {
+// Predecessor chains kept from the closure search of one terminal: the vertices on its shortest paths
+// to the later terminals with their predecessor edges. Without vertices, the paths have to be recomputed.
+typedef struct {
+	int n;
+	int *vertices;
+	int *preEdges;
+} PathChain;
+
+static void freePathChains(PathChain *chains, int n) {
+	if (chains == NULL) {
+		return;
+	}
+	for (int i = 0; i < n; i++) {
+		free(chains[i].vertices);
+		free(chains[i].preEdges);
+	}
+	free(chains);
+}
+
+// Stores the chain of source i if it fits into the remaining number of pairs
+static void keepPathChain(int i, Terminals *terms, PathsData *pathsData, Buffer *chainBuff, bool *onChain, long long *nFreePairs, PathChain *chains, Graph *g) {
+	int s = terms->vertices[i];
+	int *chainVertices = (int*)chainBuff->data;
+	chainBuff->n = 0;
+	for (int j = i+1; j < terms->n; j++) {
+		int u = terms->vertices[j];
+		if (getDist(u, pathsData) == DBL_MAX) {
+			continue;
+		}
+		// Paths to later terminals share their beginning, stop at the first known vertex
+		while (u != s && !onChain[u]) {
+			onChain[u] = true;
+			appendToBuffer(chainBuff, &u);
+			chainVertices = (int*)chainBuff->data;
+			u = getPredecessor(u, g->edges[pathsData->preEdgeIndices[u]]);
+		}
+	}
+	for (int k = 0; k < chainBuff->n; k++) {
+		onChain[chainVertices[k]] = false;
+	}
+
+	long long nLeft;
+	#pragma omp atomic capture
+	nLeft = *nFreePairs -= chainBuff->n;
+	if (nLeft < 0) {
+		// Over the memory cap, give the reservation back and recompute the paths later
+		#pragma omp atomic
+		*nFreePairs += chainBuff->n;
+		return;
+	}
+
+	PathChain *chain = &chains[i];
+	chain->n = chainBuff->n;
+	chain->vertices = calloc(chain->n + 1, sizeof(int));
+	chain->preEdges = calloc(chain->n + 1, sizeof(int));
+	for (int k = 0; k < chain->n; k++) {
+		chain->vertices[k] = chainVertices[k];
+		chain->preEdges[k] = pathsData->preEdgeIndices[chainVertices[k]];
+	}
+}
+
+// Provides the shortest paths from terminal i in pathsData, from its chain if it was kept
+static void loadPathsFrom(int i, int target, int *terminals, PathChain *chains, PathsData *pathsData, Graph *g) {
+	if (chains == NULL || chains[i].vertices == NULL) {
+		if (target == -1) {
+			dijkstra(terminals[i], pathsData, g);
+		}
+		else {
+			dijkstraToTarget(terminals[i], target, pathsData, g);
+		}
+		return;
+	}
+	for (int k = 0; k < chains[i].n; k++) {
+		pathsData->preEdgeIndices[chains[i].vertices[k]] = chains[i].preEdges[k];
+	}
+}
+
+static void unloadPathsFrom(int i, PathChain *chains, PathsData *pathsData) {
+	if (chains == NULL || chains[i].vertices == NULL) {
+		cleanPathsData(pathsData);
+		return;
+	}
+	for (int k = 0; k < chains[i].n; k++) {
+		pathsData->preEdgeIndices[chains[i].vertices[k]] = -1;
+	}
+}
+
+DistanceMatrix *createMetricClosure(Graph *g, Terminals *terms, PathChain *chains, long long maxChainPairs) {
 	int *terminals = terms->vertices;
 	int nTerminals = terms->n;
 
 	int nThreads = omp_get_max_threads();
 	PathsData **pathsDatas = createMultiPathDatas(nThreads, g->n);
-	Buffer *tBuffs = createBuffers(nThreads, sizeof(Edge));
+	DistanceMatrix *closure = createDistanceMatrix(nTerminals);
+
+	// Searches can stop once all terminals are settled
+	bool *isTerminal = calloc(g->n, sizeof(bool));
+	int nDistinctTerminals = 0;
+	for (int i = 0; i < nTerminals; i++) {
+		if (!isTerminal[terminals[i]]) {
+			isTerminal[terminals[i]] = true;
+			nDistinctTerminals++;
+		}
+	}
+
+	Buffer *chainBuffs = NULL;
+	bool *onChain = NULL;
+	long long nFreePairs = maxChainPairs;
+	if (chains != NULL) {
+		chainBuffs = createBuffers(nThreads, sizeof(int));
+		onChain = calloc((size_t)nThreads * g->n, sizeof(bool));
+	}
 
-	// Collect edges in parallel
+	// Fill the rows of the closure in parallel, row i only holds the distances from terminal i
 	#pragma omp parallel for schedule(dynamic)
 	for (int i = 0; i < nTerminals-1; i++) { // Last dijkstra info has already been computed by other runs
 		int tID = omp_get_thread_num();
 		PathsData *localPathsData = pathsDatas[tID];
 
 		int v = terminals[i];
-		dijkstra(v, localPathsData, g);
+		dijkstraUntilSettled(&v, 1, isTerminal, nDistinctTerminals, localPathsData, g);
 
-		for (int j = i+1; j < nTerminals; j++) {
-			int w = terminals[j];
-			if (localPathsData->dist[w] != DBL_MAX) {
-				Edge e = {i, j, localPathsData->dist[w]};
-				appendToBuffer(&tBuffs[tID], &e);
-			}
+		if (chains != NULL) {
+			keepPathChain(i, terms, localPathsData, &chainBuffs[tID], &onChain[(size_t)tID * g->n], &nFreePairs, chains, g);
 		}
-		cleanPathsData(localPathsData, g->n);
-	}
 
-	// Merge collected edges
-	Graph *closure = createGraph(nTerminals, nTerminals * (nTerminals-1)/2);
-	int nEdges = 0;
-	for (int t = 0; t < nThreads; t++) {
-		Edge *edges = (Edge*) tBuffs[t].data;
-		for (int i = 0; i < tBuffs[t].n; i++) {
-			Edge e = edges[i];
-			addEdge(e.v, e.w, e.cost, nEdges, closure);
-			nEdges++;
+		double *row = &closure->dist[distanceIndex(i, i+1, nTerminals)];
+		for (int j = i+1; j < nTerminals; j++) {
+			row[j-i-1] = getDist(terminals[j], localPathsData); // Stays DBL_MAX for unreachable pairs
 		}
+		cleanPathsData(localPathsData);
 	}
 
-	freeBuffers(tBuffs, nThreads);
+	if (chains != NULL) {
+		freeBuffers(chainBuffs, nThreads);
+		free(onChain);
+	}
+	free(isTerminal);
 	freeMultiPathsDatas(pathsDatas, nThreads);
 	return closure;
 }
 
-static int mergeCollectedSets(Buffer *edgeBuffs, int nThreads, int *collectedEdgeIndices, int *treeVertices, int *nTreeVertices, bool *inTree, bool *edgesVisited, Graph *g) {
-	int nEdges = 0;
-
-	for (int tID = 0; tID < nThreads; tID++) {
-		Buffer tBuff = edgeBuffs[tID];
-		int *edgeIndices = (int*)tBuff.data;
-		
-		for (int i = 0; i < tBuff.n; i++) {
-			int edgeI = edgeIndices[i];
-
-			if (!edgesVisited[edgeI]) {
-				collectedEdgeIndices[nEdges] = edgeI;
-				nEdges++;
-				edgesVisited[edgeI] = true;
-
-				Edge e = g->edges[edgeI];
-				*nTreeVertices = updateTreeVertices(e.v, treeVertices, inTree, *nTreeVertices);
-				*nTreeVertices = updateTreeVertices(e.w, treeVertices, inTree, *nTreeVertices);
-			}
-		}
+// Closure MST edge of terminal i as pair of terminal indices v < w, the paths are searched from v.
+// Returns false for the root and for terminals that are not connected to it.
+static bool getClosureMSTEdge(int i, int *closurePreds, int *v, int *w) {
+	int p = closurePreds[i];
+	if (p == -1) {
+		return false;
 	}
-	return nEdges;
+	*v = p < i ? p : i;
+	*w = p < i ? i : p;
+	return true;
 }
 
 static int processEdgeOfPath(int u, Graph *g, PathsData *pathsData, Buffer *buff, int *nEdges, bool *edgesVisited, int *treeVertices, int *nTreeVertices, bool *inTree) {
@@ -116,19 +206,22 @@ static int processEdgeOfPath(int u, Graph *g, PathsData *pathsData, Buffer *buff
 	return getPredecessor(u, preEdge);
 }
 
-static void collectUniqueEdges(Graph *g, Graph *closure, int *terminals, int *closureMSTindices, int nClosure, PathsData *pathsData, Buffer *buff, int *nEdges, int *treeVertices, bool *inTree, int *nTreeVertices, bool *edgesVisited) {
-	int lastSource = -1;
-	for (int i = 1; i < nClosure; i++) {
-		int closureEdgeI = closureMSTindices[i];
-
-		Edge closureEdge = closure->edges[closureEdgeI];
-		int t1 = terminals[closureEdge.v];
-		int t2 = terminals[closureEdge.w];
+static void collectUniqueEdges(Graph *g, int *terminals, int *closurePreds, int nClosure, PathChain *chains, PathsData *pathsData, Buffer *buff, int *nEdges, int *treeVertices, bool *inTree, int *nTreeVertices, bool *edgesVisited) {
+	int lastSourceI = -1;
+	for (int i = 0; i < nClosure; i++) {
+		int sourceI, targetI;
+		if (!getClosureMSTEdge(i, closurePreds, &sourceI, &targetI)) {
+			continue;
+		}
+		int t1 = terminals[sourceI];
+		int t2 = terminals[targetI];
 	
-		if (t1 != lastSource) {
-			cleanPathsData(pathsData, g->n);
-			dijkstra(t1, pathsData, g);
-			lastSource = t1;
+		if (sourceI != lastSourceI) {
+			if (lastSourceI != -1) {
+				unloadPathsFrom(lastSourceI, chains, pathsData);
+			}
+			loadPathsFrom(sourceI, -1, terminals, chains, pathsData, g);
+			lastSourceI = sourceI;
 		}
 
 		// Set boundaries for the parts of the path to add
@@ -163,45 +256,82 @@ static void collectUniqueEdges(Graph *g, Graph *closure, int *terminals, int *cl
 	}
 }
 
-static void collectEdgesForParallel(Graph *g, Graph *closure, int *terminals, int *closureMST, int nClosure, PathsData **pathsDatas, Buffer *edgeBuffs) {
+static void appendIfNew(int i, AtomicBitset *bits, Buffer *buff) {
+	if (!testAndSetBit(i, bits)) {
+		appendToBuffer(buff, &i);
+	}
+}
+
+static void collectEdgesForParallel(Graph *g, int *terminals, int *closurePreds, int nClosure, PathChain *chains, PathsData **pathsDatas, AtomicBitset *edgeBits, AtomicBitset *vertexBits, Buffer *edgeBuffs, Buffer *vertexBuffs) {
 	#pragma omp parallel for schedule(dynamic)
-	for (int i = 1; i < nClosure; i++) {
+	for (int i = 0; i < nClosure; i++) {
 		int tID = omp_get_thread_num();
 		
-		int closureEdgeI = closureMST[i];
-		Edge closureEdge = closure->edges[closureEdgeI];
-		int t1 = terminals[closureEdge.v];
-		int t2 = terminals[closureEdge.w];
+		int sourceI, targetI;
+		if (!getClosureMSTEdge(i, closurePreds, &sourceI, &targetI)) {
+			continue;
+		}
+		int t1 = terminals[sourceI];
+		int t2 = terminals[targetI];
 		
-		dijkstra(t1, pathsDatas[tID], g);
+		loadPathsFrom(sourceI, t2, terminals, chains, pathsDatas[tID], g);
 
-		// Process shortest path and add its edges
+		// Process shortest path, only the thread that claims an edge or vertex first records it
 		int u = t2;
 		while (u != -1 && u != t1) {
 			int preEdgeI = pathsDatas[tID]->preEdgeIndices[u];
 			Edge preEdge = g->edges[preEdgeI];
 
-			appendToBuffer(&edgeBuffs[tID], &preEdgeI);
+			if (!testAndSetBit(preEdgeI, edgeBits)) {
+				appendToBuffer(&edgeBuffs[tID], &preEdgeI);
+				appendIfNew(preEdge.v, vertexBits, &vertexBuffs[tID]);
+				appendIfNew(preEdge.w, vertexBits, &vertexBuffs[tID]);
+			}
 
 			u = getPredecessor(u, preEdge);
 		}
-		cleanPathsData(pathsDatas[tID], g->n);
+		unloadPathsFrom(sourceI, chains, pathsDatas[tID]);
 	}
 }
 
-static bool createClosureMST(Graph *g, Terminals *terms, Graph **closure, int **closureMSTindices) {
-	*closure = createMetricClosure(g, terms);
-	*closureMSTindices = prim(*closure, 0);
-	if (*closureMSTindices == NULL) {
-		freeGraph(*closure);
-		return false;
+// Concatenates the per-thread buffers of ints into one array
+static int *concatBuffers(Buffer *buffs, int nBuffs, int *n) {
+	int *starts = calloc(nBuffs+1, sizeof(int));
+	for (int t = 0; t < nBuffs; t++) {
+		starts[t+1] = starts[t] + buffs[t].n;
 	}
-	return true;
+	*n = starts[nBuffs];
+	int *all = calloc(*n + 1, sizeof(int));
+
+	#pragma omp parallel for
+	for (int t = 0; t < nBuffs; t++) {
+		memcpy(&all[starts[t]], buffs[t].data, buffs[t].n * sizeof(int));
+	}
+	free(starts);
+	return all;
+}
+
+// Dense Prim over the closure matrix, which avoids storing the closure as complete graph with adjacency
+static int *createClosureMST(Graph *g, Terminals *terms, long chainMemory, PathChain **chains) {
+	*chains = NULL;
+	if (chainMemory > 0) {
+		*chains = calloc(terms->n, sizeof(PathChain));
+	}
+	long long maxChainPairs = chainMemory / (2 * sizeof(int));
+	double start = startPhase();
+	DistanceMatrix *closure = createMetricClosure(g, terms, *chains, maxChainPairs);
+	endPhase(PHASE_CLOSURE, start);
+
+	start = startPhase();
+	int *closurePreds = densePrim(closure, 0);
+	freeDistanceMatrix(closure);
+	endPhase(PHASE_CLOSURE_MST, start);
+	return closurePreds;
 }
 
 static int *prune(Graph *g, InducedSubGraph indSubG, int *nFinalEdges, bool *edgesVisited) {
 	// Creating induced subgraph from selected vertices and edges
-	int *mstEdgeIndicesInIndG = prim(indSubG.graph, 0);
+	int *mstEdgeIndicesInIndG = minimumSpanningTree(indSubG.graph, 0);
 
 	// Build final Steiner Tree from MST edges
 	int *stEdges = calloc(g->n, sizeof(int));
@@ -219,6 +349,7 @@ static int *prune(Graph *g, InducedSubGraph indSubG, int *nFinalEdges, bool *edg
 }
 
 static SteinerTree pruneAndCleanup(Graph *g, int *edgeIndices, int nEdges, bool *edgesVisited, int *treeVertices, int nTreeVertices) {
+	double start = startPhase();
 	int nFinalEdges = 0;
 	InducedSubGraph indSubG = createInducedSubGraph(treeVertices, nTreeVertices, edgesVisited, g);
 	
@@ -226,34 +357,33 @@ static SteinerTree pruneAndCleanup(Graph *g, int *edgeIndices, int nEdges, bool
 	
 	int *stEdgeIndices = prune(g, indSubG, &nFinalEdges, edgesVisited);
 	freeInducedSubGraph(indSubG);
+	endPhase(PHASE_PRUNE, start);
 	
 	return (SteinerTree){stEdgeIndices, nFinalEdges};
 }
 
-SteinerTree twoAPX(Graph *g, Terminals *terms) {
+SteinerTree twoAPX(Graph *g, Terminals *terms, long chainMemory) {
 	int *terminals = terms->vertices;
 	PathsData *pathsData = createPathsData(g->n);
 
 	Buffer *edgesBuff = createBuffer(sizeof(int));
 	int nEdges = 0;
 
-	Graph *closure;
-	int *closureMSTindices;
-	if (!createClosureMST(g, terms, &closure, &closureMSTindices)) {
-		freePathsData(pathsData);
-		return (SteinerTree){NULL, 0};
-	}
+	PathChain *chains;
+	int *closurePreds = createClosureMST(g, terms, chainMemory, &chains);
 
 	int nTreeVertices = 0;
 	int *treeVertices = calloc(g->n, sizeof(int));
 	bool *inTree = calloc(g->n, sizeof(bool));
 	bool *edgesVisited = calloc(g->m, sizeof(bool));
 
-	collectUniqueEdges(g, closure, terminals, closureMSTindices, closure->n, pathsData, edgesBuff, &nEdges, treeVertices, inTree, &nTreeVertices, edgesVisited);
+	double start = startPhase();
+	collectUniqueEdges(g, terminals, closurePreds, terms->n, chains, pathsData, edgesBuff, &nEdges, treeVertices, inTree, &nTreeVertices, edgesVisited);
+	endPhase(PHASE_COLLECT_PATHS, start);
 
 	freePathsData(pathsData);
-	free(closureMSTindices);
-	freeGraph(closure);
+	free(closurePreds);
+	freePathChains(chains, terms->n);
 
 	int *edgeIndices = (int*)edgesBuff->data;
 	SteinerTree st = pruneAndCleanup(g, edgeIndices, nEdges, edgesVisited, treeVertices, nTreeVertices);
@@ -266,38 +396,138 @@ SteinerTree twoAPX(Graph *g, Terminals *terms) {
 	return st;
 }
 
-SteinerTree parallelTwoAPX(Graph *g, Terminals *terms) {
+SteinerTree parallelTwoAPX(Graph *g, Terminals *terms, long chainMemory) {
 	int *terminals = terms->vertices;
 
-	Graph *closure = NULL;
-	int *closureMSTindices = NULL;
-	if (!createClosureMST(g, terms, &closure, &closureMSTindices)) {
-		return (SteinerTree){NULL, 0};
-	}
+	PathChain *chains = NULL;
+	int *closurePreds = createClosureMST(g, terms, chainMemory, &chains);
 
 	int nThreads = omp_get_max_threads();
 	PathsData **pathsDatas = createMultiPathDatas(nThreads, g->n);
 	Buffer *edgeBuffs = createBuffers(nThreads, sizeof(int));
-	bool *edgesVisited = calloc(g->m, sizeof(bool));
+	Buffer *vertexBuffs = createBuffers(nThreads, sizeof(int));
+	AtomicBitset *edgeBits = createAtomicBitset(g->m);
+	AtomicBitset *vertexBits = createAtomicBitset(g->n);
+
+	double start = startPhase();
+	collectEdgesForParallel(g, terminals, closurePreds, terms->n, chains, pathsDatas, edgeBits, vertexBits, edgeBuffs, vertexBuffs);
+	endPhase(PHASE_COLLECT_PATHS, start);
 
-	collectEdgesForParallel(g, closure, terminals, closureMSTindices, closure->n, pathsDatas, edgeBuffs);
+	freeMultiPathsDatas(pathsDatas, nThreads);
+	freeAtomicBitset(edgeBits);
+	freeAtomicBitset(vertexBits);
+	free(closurePreds);
+	freePathChains(chains, terms->n);
 
+	// Buffers hold unique entries already, so merging only concatenates them
+	int nEdges = 0;
 	int nTreeVertices = 0;
+	int *collectedEdges = concatBuffers(edgeBuffs, nThreads, &nEdges);
+	int *treeVertices = concatBuffers(vertexBuffs, nThreads, &nTreeVertices);
+	freeBuffers(edgeBuffs, nThreads);
+	freeBuffers(vertexBuffs, nThreads);
+
+	bool *edgesVisited = calloc(g->m, sizeof(bool));
+	#pragma omp parallel for
+	for (int i = 0; i < nEdges; i++) {
+		edgesVisited[collectedEdges[i]] = true;
+	}
+
+	SteinerTree st = pruneAndCleanup(g, collectedEdges, nEdges, edgesVisited, treeVertices, nTreeVertices);
+
+	free(collectedEdges);
+	free(edgesVisited);
+	free(treeVertices);
+
+	return st;
+}
+
+// Terminal graph of Mehlhorn: one vertex per terminal and one edge per graph edge between two Voronoi regions,
+// weighted by the length of the shortest path between the terminals using that edge
+static Graph *createVoronoiTerminalGraph(Graph *g, Terminals *terms, PathsData *pathsData, int *bases, int **crossingEdges) {
+	int *terminalIndices = calloc(g->n, sizeof(int));
+	for (int i = terms->n-1; i >= 0; i--) {
+		terminalIndices[terms->vertices[i]] = i; // Duplicate terminals map to their first occurrence
+	}
+
+	int nCrossing = 0;
+	for (int i = 0; i < g->m; i++) {
+		Edge e = g->edges[i];
+		if (bases[e.v] >= 0 && bases[e.w] >= 0 && bases[e.v] != bases[e.w]) {
+			nCrossing++;
+		}
+	}
+
+	Graph *terminalGraph = createGraph(terms->n, nCrossing);
+	*crossingEdges = calloc(nCrossing+1, sizeof(int));
+	nCrossing = 0;
+	for (int i = 0; i < g->m; i++) {
+		Edge e = g->edges[i];
+		if (bases[e.v] >= 0 && bases[e.w] >= 0 && bases[e.v] != bases[e.w]) {
+			double cost = getDist(e.v, pathsData) + e.cost + getDist(e.w, pathsData);
+			addEdge(terminalIndices[bases[e.v]], terminalIndices[bases[e.w]], cost, nCrossing, terminalGraph);
+			(*crossingEdges)[nCrossing] = i;
+			nCrossing++;
+		}
+	}
+	buildAdjacency(terminalGraph);
+
+	free(terminalIndices);
+	return terminalGraph;
+}
+
+SteinerTree mehlhornTwoAPX(Graph *g, Terminals *terms) {
+	// A single search from all terminals partitions the graph into Voronoi regions
+	PathsData *pathsData = createPathsData(g->n);
+	multiDijkstra(terms->vertices, terms->n, pathsData, g);
+	int *bases = findNearestSources(pathsData, g);
+
+	int *crossingEdges;
+	Graph *terminalGraph = createVoronoiTerminalGraph(g, terms, pathsData, bases, &crossingEdges);
+	int *terminalMSTindices = minimumSpanningTree(terminalGraph, 0);
+
+	int *edgeIndices = calloc(g->m, sizeof(int));
+	int nEdges = 0;
 	int *treeVertices = calloc(g->n, sizeof(int));
+	int nTreeVertices = 0;
 	bool *inTree = calloc(g->n, sizeof(bool));
-	int *collectedEdges = calloc(g->m, sizeof(int));
+	bool *edgesVisited = calloc(g->m, sizeof(bool));
 
-	int nEdges = mergeCollectedSets(edgeBuffs, nThreads, collectedEdges, treeVertices, 
-	&nTreeVertices, inTree, edgesVisited, g);
+	// Each MST edge is the path from the crossing edge's endpoints back to the bases of their regions
+	for (int i = 0; i < terminalGraph->n; i++) {
+		if (terminalMSTindices[i] == -1) {
+			continue; // Root or terminal of another component
+		}
+		int crossingI = crossingEdges[terminalMSTindices[i]];
+		Edge crossing = g->edges[crossingI];
+		nEdges = addEdgeToEdges(crossingI, edgeIndices, nEdges, edgesVisited);
+		nTreeVertices = updateTreeVertices(crossing.v, treeVertices, inTree, nTreeVertices);
+		nTreeVertices = updateTreeVertices(crossing.w, treeVertices, inTree, nTreeVertices);
+
+		int ends[2] = {crossing.v, crossing.w};
+		for (int j = 0; j < 2; j++) {
+			int u = ends[j];
+			while (pathsData->preEdgeIndices[u] != -1) {
+				int edgeI = pathsData->preEdgeIndices[u];
+				if (edgesVisited[edgeI]) {
+					break; // Rest of the path has already been added
+				}
+				nEdges = addEdgeToEdges(edgeI, edgeIndices, nEdges, edgesVisited);
+				u = getPredecessor(u, g->edges[edgeI]);
+				nTreeVertices = updateTreeVertices(u, treeVertices, inTree, nTreeVertices);
+			}
+		}
+	}
 
-	freeMultiPathsDatas(pathsDatas, nThreads);
-	freeBuffers(edgeBuffs, nThreads);
-	free(closureMSTindices);
-	freeGraph(closure);
+	free(terminalMSTindices);
+	freeGraph(terminalGraph);
+	free(crossingEdges);
+	free(bases);
+	freePathsData(pathsData);
 
-	SteinerTree st = pruneAndCleanup(g, collectedEdges, nEdges, edgesVisited, treeVertices, nTreeVertices);
+	SteinerTree st = pruneAndCleanup(g, edgeIndices, nEdges, edgesVisited, treeVertices, nTreeVertices);
 
-	free(collectedEdges);
+	free(edgeIndices);
 	free(edgesVisited);
 	free(treeVertices);
 	free(inTree);
@@ -4,8 +4,12 @@
 #include "../../structures/graph.h"
 #include "../../utils.h"
 
-SteinerTree twoAPX(Graph *g, Terminals *terms);
+// With chainMemory > 0, up to chainMemory bytes of shortest paths from the metric closure are kept
+// for the path expansion instead of searching them again
+SteinerTree twoAPX(Graph *g, Terminals *terms, long chainMemory);
 
-SteinerTree parallelTwoAPX(Graph *g, Terminals *terms);
+SteinerTree parallelTwoAPX(Graph *g, Terminals *terms, long chainMemory);
+
+SteinerTree mehlhornTwoAPX(Graph *g, Terminals *terms);
 
 #endif
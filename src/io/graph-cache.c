@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "graph-cache.h"
+
+#define CACHE_MAGIC "MCSTGRPH"
+#define CACHE_VERSION 1
+#define CACHE_SUFFIX ".cache"
+
+// Layout of a cache file (native byte order, every section 8-byte aligned):
+// header | edges | offsets | adjVertices | adjEdges | adjCosts | terminals
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t edgeSize; // sizeof(Edge) of the writer, guards against layout changes
+	int64_t sourceSize; // Size of the .gr file the cache was created from
+	int32_t n;
+	int32_t m;
+	int32_t nTerminals;
+	int32_t reserved;
+	int64_t edgesOffset;
+	int64_t offsetsOffset;
+	int64_t adjVerticesOffset;
+	int64_t adjEdgesOffset;
+	int64_t adjCostsOffset;
+	int64_t terminalsOffset;
+	int64_t fileSize;
+} CacheHeader;
+
+static int64_t align8(int64_t offset) {
+	return (offset + 7) & ~(int64_t)7;
+}
+
+static void getCachePath(const char *filePath, char *cachePath, size_t size) {
+	snprintf(cachePath, size, "%s%s", filePath, CACHE_SUFFIX);
+}
+
+static CacheHeader createHeader(Graph *g, Terminals *terms, int64_t sourceSize) {
+	CacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+	header.version = CACHE_VERSION;
+	header.edgeSize = sizeof(Edge);
+	header.sourceSize = sourceSize;
+	header.n = g->n;
+	header.m = g->m;
+	header.nTerminals = terms->n;
+
+	int64_t offset = align8(sizeof(CacheHeader));
+	header.edgesOffset = offset;
+	offset = align8(offset + (int64_t)g->m * sizeof(Edge));
+	header.offsetsOffset = offset;
+	offset = align8(offset + (int64_t)(g->n + 1) * sizeof(int));
+	header.adjVerticesOffset = offset;
+	offset = align8(offset + (int64_t)2 * g->m * sizeof(int));
+	header.adjEdgesOffset = offset;
+	offset = align8(offset + (int64_t)2 * g->m * sizeof(int));
+	header.adjCostsOffset = offset;
+	offset = align8(offset + (int64_t)2 * g->m * sizeof(double));
+	header.terminalsOffset = offset;
+	offset = align8(offset + (int64_t)terms->n * sizeof(int));
+	header.fileSize = offset;
+	return header;
+}
+
+static bool writeSection(FILE *file, int64_t offset, const void *data, size_t size) {
+	static const char zeros[8] = {0};
+	long pos = ftell(file);
+	if (pos < 0 || pos > offset || fwrite(zeros, 1, offset - pos, file) != (size_t)(offset - pos)) {
+		return false; // Padding up to the aligned section start failed
+	}
+	return fwrite(data, 1, size, file) == size;
+}
+
+bool writeGraphCache(const char *filePath, Graph *g, Terminals *terms) {
+	struct stat sourceStat;
+	if (stat(filePath, &sourceStat) == -1) {
+		perror("Error reading graph file");
+		return false;
+	}
+	char cachePath[4096];
+	getCachePath(filePath, cachePath, sizeof(cachePath));
+
+	// Write to a temporary file first so concurrent runs never see a partial cache
+	char tmpPath[4096 + 32];
+	snprintf(tmpPath, sizeof(tmpPath), "%s.tmp%d", cachePath, (int)getpid());
+	FILE *file = fopen(tmpPath, "wb");
+	if (!file) {
+		perror("Error creating graph cache");
+		return false;
+	}
+
+	// Costs are always cached as double
+	double *adjCosts = g->adjCosts;
+	if (adjCosts == NULL) {
+		adjCosts = calloc((size_t)2 * g->m, sizeof(double));
+		for (long long i = 0; i < 2LL * g->m; i++) {
+			adjCosts[i] = g->adjIntCosts[i];
+		}
+	}
+
+	CacheHeader header = createHeader(g, terms, sourceStat.st_size);
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+		&& writeSection(file, header.edgesOffset, g->edges, (size_t)g->m * sizeof(Edge))
+		&& writeSection(file, header.offsetsOffset, g->offsets, (size_t)(g->n + 1) * sizeof(int))
+		&& writeSection(file, header.adjVerticesOffset, g->adjVertices, (size_t)2 * g->m * sizeof(int))
+		&& writeSection(file, header.adjEdgesOffset, g->adjEdges, (size_t)2 * g->m * sizeof(int))
+		&& writeSection(file, header.adjCostsOffset, adjCosts, (size_t)2 * g->m * sizeof(double))
+		&& writeSection(file, header.terminalsOffset, terms->vertices, (size_t)terms->n * sizeof(int))
+		&& writeSection(file, header.fileSize, NULL, 0);
+	if (adjCosts != g->adjCosts) {
+		free(adjCosts);
+	}
+
+	if (fclose(file) != 0 || !ok || rename(tmpPath, cachePath) != 0) {
+		perror("Error writing graph cache");
+		remove(tmpPath);
+		return false;
+	}
+	return true;
+}
+
+static bool isValidHeader(const CacheHeader *header, int64_t cacheSize, int64_t sourceSize) {
+	return memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) == 0
+		&& header->version == CACHE_VERSION
+		&& header->edgeSize == sizeof(Edge)
+		&& header->sourceSize == sourceSize
+		&& header->fileSize == cacheSize
+		&& header->n >= 0 && header->m >= 0 && header->nTerminals >= 0;
+}
+
+Graph *loadGraphCache(const char *filePath, Terminals *terms) {
+	char cachePath[4096];
+	getCachePath(filePath, cachePath, sizeof(cachePath));
+
+	struct stat cacheStat;
+	struct stat sourceStat;
+	if (stat(cachePath, &cacheStat) == -1 || stat(filePath, &sourceStat) == -1) {
+		return NULL; // No cache present
+	}
+	if (cacheStat.st_mtime < sourceStat.st_mtime || cacheStat.st_size < (off_t)sizeof(CacheHeader)) {
+		return NULL; // Cache is outdated
+	}
+
+	int fd = open(cachePath, O_RDONLY);
+	if (fd == -1) {
+		return NULL;
+	}
+	// Private writable mapping: pages are only copied if an algorithm writes to them
+	char *data = mmap(NULL, cacheStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return NULL;
+	}
+
+	CacheHeader *header = (CacheHeader*)data;
+	if (!isValidHeader(header, cacheStat.st_size, sourceStat.st_size)) {
+		munmap(data, cacheStat.st_size);
+		return NULL;
+	}
+
+	Graph *g = calloc(1, sizeof(Graph));
+	*g = (Graph){
+		header->n,
+		header->m,
+		(Edge*)(data + header->edgesOffset),
+		(int*)(data + header->offsetsOffset),
+		(int*)(data + header->adjVerticesOffset),
+		(int*)(data + header->adjEdgesOffset),
+		(double*)(data + header->adjCostsOffset),
+		data,
+		cacheStat.st_size
+	};
+	classifyCosts(g);
+	if (g->costType == INT32_COSTS) {
+		// The cache holds double costs, the searches need them as int
+		g->adjIntCosts = calloc((size_t)2 * g->m, sizeof(int));
+		for (long long i = 0; i < 2LL * g->m; i++) {
+			g->adjIntCosts[i] = (int)g->adjCosts[i];
+		}
+	}
+
+	// Terminals are small and owned by the caller
+	terms->n = header->nTerminals;
+	terms->vertices = calloc(terms->n, sizeof(int));
+	memcpy(terms->vertices, data + header->terminalsOffset, (size_t)terms->n * sizeof(int));
+	return g;
+}
@@ -0,0 +1,14 @@
+#ifndef GRAPH_CACHE_H
+#define GRAPH_CACHE_H
+
+#include <stdbool.h>
+
+#include "../structures/graph.h"
+
+// The cache of a graph file is stored next to it as <filePath>.cache
+bool writeGraphCache(const char *filePath, Graph *g, Terminals *terms);
+
+// Returns NULL if no up-to-date cache exists for the graph file
+Graph *loadGraphCache(const char *filePath, Terminals *terms);
+
+#endif
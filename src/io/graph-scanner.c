@@ -0,0 +1,447 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <omp.h>
+
+#include "graph-scanner.h"
+
+#define PARALLEL_SCAN_MIN_BYTES (1 << 22) // Only split files larger than 4 MiB across threads
+#define MAX_EXACT_DIGITS 15 // Mantissas with at most 15 digits are exact in a double
+#define MAX_TOKEN_LEN 64
+
+typedef struct {
+	const char *start;
+	const char *end;
+	int nEdges;
+	int nTerminals;
+} Chunk;
+
+// Powers of ten that are exactly representable as double
+static const double pow10Table[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+MappedFile mapFile(const char *filePath) {
+	int fd = open(filePath, O_RDONLY);
+	if (fd == -1) {
+		perror("Error opening file");
+		exit(EXIT_FAILURE);
+	}
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) == -1) {
+		perror("Error reading file");
+		exit(EXIT_FAILURE);
+	}
+	if (fileStat.st_size == 0) {
+		fprintf(stderr, "Error: File %s is empty.\n", filePath);
+		exit(EXIT_FAILURE);
+	}
+
+	void *data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // Mapping stays valid after closing
+	if (data == MAP_FAILED) {
+		perror("Error mapping file");
+		exit(EXIT_FAILURE);
+	}
+	posix_madvise(data, fileStat.st_size, POSIX_MADV_SEQUENTIAL);
+
+	return (MappedFile){data, fileStat.st_size};
+}
+
+void unmapFile(MappedFile file) {
+	munmap((void*)file.data, file.size);
+}
+
+static bool isBlank(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+static const char *skipBlanks(const char *p, const char *end) {
+	while (p < end && isBlank(*p)) {
+		p++;
+	}
+	return p;
+}
+
+static const char *skipLine(const char *p, const char *end) {
+	while (p < end && *p != '\n') {
+		p++;
+	}
+	return p < end ? p+1 : end;
+}
+
+static bool startsWithWord(const char *p, const char *end, const char *word) {
+	while (*word != '\0') {
+		if (p == end || *p != *word) {
+			return false;
+		}
+		p++;
+		word++;
+	}
+	return p == end || isBlank(*p) || *p == '\n';
+}
+
+// Returns the record type of the line ('E' for edges, 'T' for terminals) or 0 for any other line
+static char recordType(const char *line, const char *end) {
+	const char *p = skipBlanks(line, end);
+	if (p+1 < end && (*p == 'E' || *p == 'T') && isBlank(p[1])) {
+		return *p;
+	}
+	return 0;
+}
+
+static const char *scanInt(const char *p, const char *end, int *value) {
+	p = skipBlanks(p, end);
+	if (p == end || !isDigit(*p)) {
+		return NULL;
+	}
+	long long v = 0;
+	while (p < end && isDigit(*p)) {
+		v = v*10 + (*p - '0');
+		if (v > INT32_MAX) {
+			return NULL;
+		}
+		p++;
+	}
+	*value = (int)v;
+	return p;
+}
+
+// Fallback for costs with exponents or too many digits to be converted exactly by scanCost
+static const char *scanCostSlow(const char *p, const char *end, double *value) {
+	char token[MAX_TOKEN_LEN];
+	int len = 0;
+	while (p+len < end && len < MAX_TOKEN_LEN-1 && !isBlank(p[len]) && p[len] != '\n') {
+		token[len] = p[len];
+		len++;
+	}
+	token[len] = '\0';
+
+	char *tokenEnd;
+	*value = strtod(token, &tokenEnd);
+	if (tokenEnd == token) {
+		return NULL;
+	}
+	return p + (tokenEnd - token);
+}
+
+static const char *scanCost(const char *p, const char *end, double *value) {
+	p = skipBlanks(p, end);
+	const char *start = p;
+
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+	uint64_t mantissa = 0;
+	int nDigits = 0;
+	int nFracDigits = 0;
+	while (p < end && isDigit(*p)) {
+		mantissa = mantissa*10 + (*p - '0');
+		nDigits++;
+		p++;
+	}
+	if (p < end && *p == '.') {
+		p++;
+		while (p < end && isDigit(*p)) {
+			mantissa = mantissa*10 + (*p - '0');
+			nDigits++;
+			nFracDigits++;
+			p++;
+		}
+	}
+	if (nDigits == 0) {
+		return NULL;
+	}
+	if (nDigits > MAX_EXACT_DIGITS || (p < end && (*p == 'e' || *p == 'E'))) {
+		return scanCostSlow(start, end, value);
+	}
+
+	// Both operands are exact, so the division is rounded correctly like strtod
+	double cost = (double)mantissa / pow10Table[nFracDigits];
+	*value = negative ? -cost : cost;
+	return p;
+}
+
+static void reportMalformedLine(const char *line, const char *end) {
+	int len = 0;
+	while (line+len < end && line[len] != '\n' && len < 80) {
+		len++;
+	}
+	fprintf(stderr, "Error: Malformed record in graph file: '%.*s'\n", len, line);
+}
+
+static int scanNumberOfVertices(MappedFile file) {
+	const char *end = file.data + file.size;
+	for (const char *p = file.data; p < end; p = skipLine(p, end)) {
+		const char *q = skipBlanks(p, end);
+		int n;
+		if (startsWithWord(q, end, "Nodes") && scanInt(q + 5, end, &n) != NULL) {
+			return n;
+		}
+	}
+	fprintf(stderr, "Error: Graph file does not specify the number of nodes.\n");
+	exit(EXIT_FAILURE);
+}
+
+static void splitIntoChunks(MappedFile file, Chunk *chunks, int nChunks) {
+	const char *end = file.data + file.size;
+	const char *start = file.data;
+	for (int c = 0; c < nChunks; c++) {
+		// Chunks always end directly after a line break, so no line is split
+		const char *chunkEnd = end;
+		if (c < nChunks-1) {
+			chunkEnd = skipLine(file.data + (file.size / nChunks) * (c+1), end);
+		}
+		if (chunkEnd < start) {
+			chunkEnd = start; // A single long line covers the whole chunk
+		}
+		chunks[c] = (Chunk){start, chunkEnd, 0, 0};
+		start = chunkEnd;
+	}
+}
+
+static void countRecords(Chunk *chunk) {
+	for (const char *p = chunk->start; p < chunk->end; p = skipLine(p, chunk->end)) {
+		char type = recordType(p, chunk->end);
+		if (type == 'E') {
+			chunk->nEdges++;
+		}
+		else if (type == 'T') {
+			chunk->nTerminals++;
+		}
+	}
+}
+
+static bool scanRecords(Chunk chunk, int edgeI, int termI, bool doubleEdges, Graph *g, int *terminals) {
+	const char *end = chunk.end;
+	for (const char *p = chunk.start; p < end; p = skipLine(p, end)) {
+		char type = recordType(p, end);
+		const char *q = skipBlanks(p, end) + 1;
+
+		if (type == 'E') {
+			int v, w;
+			double cost;
+			q = scanInt(q, end, &v);
+			q = q ? scanInt(q, end, &w) : NULL;
+			q = q ? scanCost(q, end, &cost) : NULL;
+			if (q == NULL || v < 1 || v > g->n || w < 1 || w > g->n) {
+				reportMalformedLine(p, end);
+				return false;
+			}
+			// Data is 1-indexed
+			v--;
+			w--;
+
+			if (doubleEdges) {
+				addEdge(v, w, cost, 2*edgeI, g);
+				addEdge(w, v, cost, 2*edgeI + 1, g);
+			}
+			else {
+				addEdge(v, w, cost, edgeI, g);
+			}
+			edgeI++;
+		}
+		else if (type == 'T') {
+			int t;
+			if (scanInt(q, end, &t) == NULL || t < 1 || t > g->n) {
+				reportMalformedLine(p, end);
+				return false;
+			}
+			terminals[termI] = t-1; // Data is 1-indexed
+			termI++;
+		}
+	}
+	return true;
+}
+
+Graph *scanGraph(const char *filePath, Terminals *terms, bool doubleEdges) {
+	MappedFile file = mapFile(filePath);
+	int n = scanNumberOfVertices(file);
+
+	int nChunks = 1;
+	if (file.size >= PARALLEL_SCAN_MIN_BYTES) {
+		nChunks = omp_get_max_threads();
+	}
+	Chunk *chunks = calloc(nChunks, sizeof(Chunk));
+	splitIntoChunks(file, chunks, nChunks);
+
+	// First pass: count records per chunk to know where each chunk writes its records
+	#pragma omp parallel for num_threads(nChunks) schedule(static, 1)
+	for (int c = 0; c < nChunks; c++) {
+		countRecords(&chunks[c]);
+	}
+
+	int *edgeStarts = calloc(nChunks, sizeof(int));
+	int *termStarts = calloc(nChunks, sizeof(int));
+	int m = 0;
+	int nTerminals = 0;
+	for (int c = 0; c < nChunks; c++) {
+		edgeStarts[c] = m;
+		termStarts[c] = nTerminals;
+		m += chunks[c].nEdges;
+		nTerminals += chunks[c].nTerminals;
+	}
+
+	Graph *g = createGraph(n, doubleEdges ? 2*m : m);
+	int *terminals = calloc(nTerminals, sizeof(int));
+
+	// Second pass: parse records into their final positions
+	bool failed = false;
+	#pragma omp parallel for num_threads(nChunks) schedule(static, 1)
+	for (int c = 0; c < nChunks; c++) {
+		if (!scanRecords(chunks[c], edgeStarts[c], termStarts[c], doubleEdges, g, terminals)) {
+			#pragma omp atomic write
+			failed = true;
+		}
+	}
+
+	free(chunks);
+	free(edgeStarts);
+	free(termStarts);
+	unmapFile(file);
+
+	if (failed) {
+		exit(EXIT_FAILURE);
+	}
+
+	buildAdjacency(g);
+	terms->n = nTerminals;
+	terms->vertices = terminals;
+	return g;
+}
+
+// Start of the line after "SECTION Tree Decomposition", NULL if there is none
+static const char *findTreeDecomposition(MappedFile file) {
+	const char *end = file.data + file.size;
+	for (const char *p = file.data; p < end; p = skipLine(p, end)) {
+		const char *q = skipBlanks(p, end);
+		if (!startsWithWord(q, end, "SECTION")) {
+			continue;
+		}
+		q = skipBlanks(q + 7, end);
+		if (startsWithWord(q, end, "Tree")) {
+			q = skipBlanks(q + 4, end);
+			if (startsWithWord(q, end, "Decomposition")) {
+				return skipLine(q, end);
+			}
+		}
+	}
+	return NULL;
+}
+
+// Reads the lines "s td <bags> <largest bag> <vertices>", "b <bag> <vertices...>" and "<bag> <bag>" (tree edges).
+// Without fill, only the bag sizes and the number of tree edges are counted.
+static bool scanDecompositionRecords(const char *start, const char *end, int n, TreeDecomposition *td, int *bagSizes, int *fill) {
+	for (const char *p = start; p < end; p = skipLine(p, end)) {
+		const char *q = skipBlanks(p, end);
+		if (q == end || *q == '\n' || *q == 'c' || *q == 's') {
+			continue; // Comments and the header, which is scanned before
+		}
+		if (startsWithWord(q, end, "END")) {
+			return true;
+		}
+		if (*q == 'b') {
+			int b;
+			q = scanInt(q + 1, end, &b);
+			if (q == NULL || b < 1 || b > td->nBags) {
+				reportMalformedLine(p, end);
+				return false;
+			}
+			b--; // Data is 1-indexed
+			int v;
+			const char *r;
+			while ((r = scanInt(q, end, &v)) != NULL) {
+				if (v < 1 || v > n) {
+					reportMalformedLine(p, end);
+					return false;
+				}
+				if (fill == NULL) {
+					bagSizes[b]++;
+				}
+				else {
+					td->bagVertices[td->bagStarts[b] + fill[b]++] = v-1;
+				}
+				q = r;
+			}
+			continue;
+		}
+		int a, b;
+		q = scanInt(q, end, &a);
+		q = q ? scanInt(q, end, &b) : NULL;
+		if (q == NULL || a < 1 || a > td->nBags || b < 1 || b > td->nBags) {
+			reportMalformedLine(p, end);
+			return false;
+		}
+		if (fill != NULL) {
+			td->treeEdges[2 * td->nTreeEdges] = a-1;
+			td->treeEdges[2 * td->nTreeEdges + 1] = b-1;
+		}
+		td->nTreeEdges++;
+	}
+	return true;
+}
+
+TreeDecomposition *scanTreeDecomposition(const char *filePath, int n) {
+	MappedFile file = mapFile(filePath);
+	const char *end = file.data + file.size;
+	const char *start = findTreeDecomposition(file);
+	if (start == NULL) {
+		unmapFile(file);
+		return NULL;
+	}
+
+	int nBags = -1;
+	for (const char *p = start; p < end && nBags == -1; p = skipLine(p, end)) {
+		const char *q = skipBlanks(p, end);
+		if (startsWithWord(q, end, "s")) {
+			q = skipBlanks(q + 1, end);
+			if (!startsWithWord(q, end, "td") || scanInt(q + 2, end, &nBags) == NULL) {
+				reportMalformedLine(p, end);
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+	if (nBags == -1) {
+		fprintf(stderr, "Error: Tree decomposition does not specify the number of bags.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// First pass counts the vertices per bag and the tree edges, the second fills them in
+	TreeDecomposition counts = {nBags, 0, NULL, NULL, 0, NULL};
+	int *bagSizes = calloc(nBags + 1, sizeof(int));
+	if (!scanDecompositionRecords(start, end, n, &counts, bagSizes, NULL)) {
+		exit(EXIT_FAILURE);
+	}
+	int nBagVertices = 0;
+	int width = -1;
+	for (int b = 0; b < nBags; b++) {
+		nBagVertices += bagSizes[b];
+		if (bagSizes[b] - 1 > width) {
+			width = bagSizes[b] - 1;
+		}
+	}
+	TreeDecomposition *td = createTreeDecomposition(nBags, nBagVertices, counts.nTreeEdges);
+	td->width = width;
+	for (int b = 0; b < nBags; b++) {
+		td->bagStarts[b+1] = td->bagStarts[b] + bagSizes[b];
+	}
+	int *fill = calloc(nBags + 1, sizeof(int));
+	td->nTreeEdges = 0;
+	scanDecompositionRecords(start, end, n, td, bagSizes, fill);
+
+	free(bagSizes);
+	free(fill);
+	unmapFile(file);
+	return td;
+}
@@ -0,0 +1,24 @@
+#ifndef GRAPH_SCANNER_H
+#define GRAPH_SCANNER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../structures/graph.h"
+#include "../structures/tree-decomposition.h"
+
+typedef struct {
+	const char *data;
+	size_t size;
+} MappedFile;
+
+MappedFile mapFile(const char *filePath);
+
+void unmapFile(MappedFile file);
+
+Graph *scanGraph(const char *filePath, Terminals *terms, bool doubleEdges);
+
+// Scans the section "Tree Decomposition" of PACE 2018 Track 2 instances, NULL if the file has none
+TreeDecomposition *scanTreeDecomposition(const char *filePath, int n);
+
+#endif
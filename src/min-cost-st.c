@@ -3,15 +3,25 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <math.h>
+#include <omp.h>
 
 #include "structures/graph.h"
+#include "io/graph-scanner.h"
+#include "io/graph-cache.h"
+#include "reductions/reductions.h"
+#include "reductions/blocks.h"
 #include "algorithms/exact/ilp.h"
+#include "algorithms/exact/dcut.h"
+#include "algorithms/exact/dreyfus-wagner.h"
+#include "algorithms/exact/tree-decomposition-dp.h"
 #include "algorithms/two-apx/two-apx.h"
 #include "algorithms/heuristic/heuristic.h"
+#include "algorithms/local-search/local-search.h"
 #include "test/test.h"
 #include "utils.h"
+#include "stats.h"
 
-typedef enum { NONE, SMALLER_MST, HEURISTIC, EXACT, TWO_APX, MST } Mode;
+typedef enum { NONE, SMALLER_MST, HEURISTIC, EXACT, TWO_APX, MEHLHORN_APX, MST } Mode;
 
 typedef struct {
 	Mode mode;
@@ -20,16 +30,24 @@ typedef struct {
 	bool reduceFlag;
 	bool upperBoundFlag;
 	bool totalCostFlag;
+	bool writeCacheFlag;
+	bool localSearchFlag;
+	bool dcutFlag;
+	bool statsFlag;
+	bool blockFlag;
+	double timeLimit;
+	long chainMemory;
 	const char *filePath;
+	TreeDecomposition *inputTD; // Only set while the input graph is solved as it is
 } Options;
 
 Options parse_arguments(int argc, char **argv) {
 	Options opts = { NONE, 0, NULL };
 	int opt;
 
-	while ((opt = getopt(argc, argv, "hxatspmucr")) != -1) {
-		if (opts.mode != NONE && opt != 't' && opt != 'p' && opt != 'u' && opt != 'c' && opt != 'r') {
-			fprintf(stderr, "Error: Multiple modes specified. Please select exactly one basis mode (-h, -x, -s, -m, or -a).\n");
+	while ((opt = getopt(argc, argv, "hxavtspmucrwldibT:k:")) != -1) {
+		if (opts.mode != NONE && opt != 't' && opt != 'p' && opt != 'u' && opt != 'c' && opt != 'r' && opt != 'w' && opt != 'l' && opt != 'd' && opt != 'i' && opt != 'b' && opt != 'T' && opt != 'k') {
+			fprintf(stderr, "Error: Multiple modes specified. Please select exactly one basis mode (-h, -x, -s, -m, -a, or -v).\n");
 			exit(EXIT_FAILURE);
 		}
 		else if (opt == 's') {
@@ -44,6 +62,9 @@ Options parse_arguments(int argc, char **argv) {
 		else if (opt == 'a') {
 			opts.mode = TWO_APX;
 		}
+		else if (opt == 'v') {
+			opts.mode = MEHLHORN_APX;
+		}
 		else if (opt == 'm') {
 			opts.mode = MST;
 		}
@@ -62,21 +83,69 @@ Options parse_arguments(int argc, char **argv) {
 		else if (opt == 'r') {
 			opts.reduceFlag = true;
 		}
+		else if (opt == 'w') {
+			opts.writeCacheFlag = true;
+		}
+		else if (opt == 'l') {
+			opts.localSearchFlag = true;
+		}
+		else if (opt == 'd') {
+			opts.dcutFlag = true;
+		}
+		else if (opt == 'i') {
+			opts.statsFlag = true;
+		}
+		else if (opt == 'b') {
+			opts.blockFlag = true;
+		}
+		else if (opt == 'k') {
+			char *end;
+			double megabytes = strtod(optarg, &end);
+			if (*end != '\0' || megabytes <= 0) {
+				fprintf(stderr, "Error: Path memory must be a positive number of MiB.\n");
+				exit(EXIT_FAILURE);
+			}
+			opts.chainMemory = (long)(megabytes * 1024 * 1024);
+		}
+		else if (opt == 'T') {
+			char *end;
+			opts.timeLimit = strtod(optarg, &end);
+			if (*end != '\0' || opts.timeLimit <= 0) {
+				fprintf(stderr, "Error: Time limit must be a positive number of seconds.\n");
+				exit(EXIT_FAILURE);
+			}
+		}
 		else {
-			fprintf(stderr, "Usage: %s [-h|-x|-a|-s|-m] [-p] [-t] [-r] [-u] [-c] <filename_of_graph>\n", argv[0]);
+			fprintf(stderr, "Usage: %s [-h|-x|-a|-v|-s|-m] [-p] [-t] [-r] [-l] [-d] [-u] [-c] [-w] [-i] [-b] [-T seconds] [-k MiB] <filename_of_graph>\n", argv[0]);
 			exit(EXIT_FAILURE);
 		}
 	}
-	if (opts.parallelFlag && opts.mode != TWO_APX) {
-		fprintf(stderr, "Error: Parallel flag must only be used with mode '-a'.\n");
+	if (opts.parallelFlag && opts.mode != TWO_APX && opts.mode != HEURISTIC) {
+		fprintf(stderr, "Error: Parallel flag must only be used with modes '-a' and '-h'.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (opts.chainMemory > 0 && opts.mode != TWO_APX) {
+		fprintf(stderr, "Error: Path memory must only be used with mode '-a'.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (opts.localSearchFlag && opts.mode == EXACT) {
+		fprintf(stderr, "Error: Local search must not be used with mode '-x'.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (opts.timeLimit > 0 && !(opts.parallelFlag && opts.mode == HEURISTIC) && !opts.localSearchFlag) {
+		fprintf(stderr, "Error: Time limit must only be used with modes '-h -p' or with '-l'.\n");
 		exit(EXIT_FAILURE);
 	}
-	if ((opts.upperBoundFlag || opts.reduceFlag) && opts.mode != EXACT) {
-		fprintf(stderr, "Error: Upper-bound and reduce flags must only be used with mode '-x'.\n");
+	if (opts.dcutFlag && opts.mode != EXACT) {
+		fprintf(stderr, "Error: DCut flag must only be used with mode '-x'.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (opts.upperBoundFlag && opts.mode != EXACT) {
+		fprintf(stderr, "Error: Upper-bound flag must only be used with mode '-x'.\n");
 		exit(EXIT_FAILURE);
 	}
 	if (opts.mode == NONE) {
-		fprintf(stderr, "Error: You must specify exactly one basis mode (-h, -x, -s, -m, or -a).\n");
+		fprintf(stderr, "Error: You must specify exactly one basis mode (-h, -x, -s, -m, -a, or -v).\n");
 		exit(EXIT_FAILURE);
 	}
 	if (optind >= argc) {
@@ -87,50 +156,144 @@ Options parse_arguments(int argc, char **argv) {
 	return opts;
 }
 
-int main(int argc, char **argv) {
-	Graph *g;
-	Terminals *terms = calloc(1, sizeof(Terminals));
+static Graph *loadGraph(Options opts, Terminals *terms) {
+	if (opts.writeCacheFlag) {
+		Graph *g = scanGraph(opts.filePath, terms, false);
+		writeGraphCache(opts.filePath, g, terms);
+		return g;
+	}
+	Graph *g = loadGraphCache(opts.filePath, terms);
+	if (g == NULL) {
+		g = scanGraph(opts.filePath, terms, false);
+	}
+	return g;
+}
+
+// Few terminals are solved by the subset DP, small treewidth by the tree decomposition DP, the ILPs take the rest
+static SteinerTree solveExact(Options opts, Graph *g, Terminals *terms) {
+	if (fitsDreyfusWagner(g, terms)) {
+		return dreyfusWagner(g, terms);
+	}
 	SteinerTree st;
-	
-	Options opts = parse_arguments(argc, argv);
+	if (treeDecompositionDP(g, terms, opts.inputTD, &st)) {
+		return st;
+	}
+	return opts.dcutFlag ? dcutIlp(g, terms, opts.upperBoundFlag) : ilp(g, terms, opts.upperBoundFlag);
+}
 
-	FILE *graphFile = fopen(opts.filePath, "r");
-	if (!graphFile) {
-		perror("Error opening file");
-		exit(EXIT_FAILURE);
+static SteinerTree solveInstance(Options opts, Graph *g, Terminals *terms) {
+	SteinerTree st;
+	if (terms->n <= 1) {
+		// Reductions can leave a single terminal, which is a tree without edges
+		st.treeEdgeIndices = calloc(1, sizeof(int));
+		st.n = 0;
+		return st;
 	}
+	double startTime = omp_get_wtime();
 
+	double start = startPhase();
 	switch (opts.mode) {
 		case SMALLER_MST:
-			g = scanGraph(graphFile, terms, false);
-			fclose(graphFile);
 			st = prunedMST(g, terms);
 			break; 
 		case HEURISTIC:
-			g = scanGraph(graphFile, terms, false);
-			fclose(graphFile);
-			st = takahashiMatsuyama(g, terms);
+			st = opts.parallelFlag ? parallelTakahashiMatsuyama(g, terms, opts.timeLimit) : takahashiMatsuyama(g, terms);
 			break;
 		case MST:
-			g = scanGraph(graphFile, terms, false);
-			fclose(graphFile);
 			st = mstST(g, terms);
 			break;
 		case EXACT:
-			g = scanGraph(graphFile, terms, true);
-			fclose(graphFile);
-			st = ilp(g, terms, opts.upperBoundFlag, opts.reduceFlag);
+			st = solveExact(opts, g, terms);
 			break;
 		case TWO_APX:
-			g = scanGraph(graphFile, terms, false);
-			fclose(graphFile);
-			st = opts.parallelFlag ? parallelTwoAPX(g, terms) : twoAPX(g, terms);
+			st = opts.parallelFlag ? parallelTwoAPX(g, terms, opts.chainMemory) : twoAPX(g, terms, opts.chainMemory);
+			break;
+		case MEHLHORN_APX:
+			st = mehlhornTwoAPX(g, terms);
 			break;
 		default:
-			freeTerminals(terms);
 			fprintf(stderr, "Mode not recognized.\n");
 			exit(EXIT_FAILURE);
 	}
+	endPhase(PHASE_SOLVE, start);
+
+	if (opts.localSearchFlag) {
+		// The time limit is shared with the construction of the tree
+		double timeLeft = 0;
+		if (opts.timeLimit > 0) {
+			timeLeft = opts.timeLimit - (omp_get_wtime() - startTime);
+			if (timeLeft <= 0) {
+				return st;
+			}
+		}
+		start = startPhase();
+		SteinerTree improved = localSearch(g, terms, st, timeLeft);
+		endPhase(PHASE_LOCAL_SEARCH, start);
+		free(st.treeEdgeIndices);
+		st = improved;
+	}
+	return st;
+}
+
+// Solves the blocks between the terminals independently and joins their trees
+static SteinerTree solveBlocks(Options opts, Graph *g, Terminals *terms) {
+	double start = startPhase();
+	BlockDecomposition bd = decomposeIntoBlocks(g, terms);
+	endPhase(PHASE_DECOMPOSE, start);
+
+	SteinerTree *blockTrees = calloc(bd.nBlocks + 1, sizeof(SteinerTree));
+	// GLPK is not thread-safe, so the ILPs of the blocks are solved one after another
+	#pragma omp parallel for schedule(dynamic, 1) if (opts.mode != EXACT)
+	for (int b = 0; b < bd.nBlocks; b++) {
+		blockTrees[b] = solveInstance(opts, bd.blocks[b].graph, bd.blockTerms[b]);
+	}
+
+	start = startPhase();
+	SteinerTree st = joinBlockSolutions(blockTrees, bd);
+	endPhase(PHASE_DECOMPOSE, start);
+	for (int b = 0; b < bd.nBlocks; b++) {
+		free(blockTrees[b].treeEdgeIndices);
+	}
+	free(blockTrees);
+	freeBlockDecomposition(bd);
+	return st;
+}
+
+static SteinerTree solve(Options opts, Graph *g, Terminals *terms) {
+	return opts.blockFlag ? solveBlocks(opts, g, terms) : solveInstance(opts, g, terms);
+}
+
+int main(int argc, char **argv) {
+	Terminals *terms = calloc(1, sizeof(Terminals));
+	SteinerTree st;
+	
+	Options opts = parse_arguments(argc, argv);
+	if (opts.statsFlag) {
+		enableStats();
+	}
+
+	double start = startPhase();
+	Graph *g = loadGraph(opts, terms);
+	if (opts.mode == EXACT && !opts.reduceFlag && !opts.blockFlag) {
+		opts.inputTD = scanTreeDecomposition(opts.filePath, g->n);
+	}
+	endPhase(PHASE_LOAD, start);
+
+	if (opts.reduceFlag) {
+		// Solve the reduced instance and map its tree back to the edges of g
+		start = startPhase();
+		ReducedInstance ri = reduceInstance(g, terms);
+		endPhase(PHASE_REDUCE, start);
+		SteinerTree reducedST = solve(opts, ri.graph, ri.terms);
+		start = startPhase();
+		st = liftSolution(reducedST, ri);
+		endPhase(PHASE_REDUCE, start);
+		free(reducedST.treeEdgeIndices);
+		freeReducedInstance(ri);
+	}
+	else {
+		st = solve(opts, g, terms);
+	}
 
 	double totalCost = sumEdgeCosts(st.treeEdgeIndices, st.n, g);
 
@@ -150,6 +313,15 @@ int main(int argc, char **argv) {
 			fprintf(stderr, "Result is not a Steiner Tree :(\n");
 			exitStatus = EXIT_FAILURE;
 		}
+		if (opts.mode == HEURISTIC) {
+			if (matchesRecomputedTM(g, terms)) {
+				fprintf(stdout, "Incremental Takahashi-Matsuyama matches the recomputing one :)\n");
+			}
+			else {
+				fprintf(stderr, "Incremental Takahashi-Matsuyama does not match the recomputing one :(\n");
+				exitStatus = EXIT_FAILURE;
+			}
+		}
 		
 		double minCost = 0.0;
 		bool hasMinCost = scanMinCost(opts.filePath, &minCost);
@@ -163,7 +335,7 @@ int main(int argc, char **argv) {
 				fprintf(stderr, "Result has not mimimum cost :(\n");
 				exitStatus = EXIT_FAILURE;
 			}
-			else if (opts.mode == TWO_APX && totalCost > 2*minCost) {
+			else if ((opts.mode == TWO_APX || opts.mode == MEHLHORN_APX) && totalCost > 2*minCost) {
 				fprintf(stderr, "Result has not two approximation :(\n");
 				exitStatus = EXIT_FAILURE;
 			}
@@ -173,6 +345,13 @@ int main(int argc, char **argv) {
 		}
 	}
 	
+	if (opts.statsFlag) {
+		printStats(stderr);
+	}
+	
+	if (opts.inputTD != NULL) {
+		freeTreeDecomposition(opts.inputTD);
+	}
 	freeGraph(g);
 	freeTerminals(terms);
 	free(st.treeEdgeIndices);
@@ -0,0 +1,368 @@
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "blocks.h"
+#include "../stats.h"
+
+// Assigns every edge in a component with a terminal to its biconnected block (Hopcroft-Tarjan without recursion).
+// Loops and edges of other components get -1. Returns the number of blocks.
+static int findBlocks(Graph *g, Terminals *terms, int *blockOf) {
+	int *disc = calloc(g->n, sizeof(int));
+	int *low = calloc(g->n, sizeof(int));
+	int *parentEdge = calloc(g->n, sizeof(int));
+	int *nextAdj = calloc(g->n, sizeof(int));
+	int *dfsStack = calloc(g->n, sizeof(int));
+	int *edgeStack = calloc(g->m + 1, sizeof(int));
+	for (int v = 0; v < g->n; v++) {
+		disc[v] = -1;
+	}
+	for (int i = 0; i < g->m; i++) {
+		blockOf[i] = -1;
+	}
+
+	int time = 0;
+	int nBlocks = 0;
+	int nEdgeStack = 0;
+	for (int t = 0; t < terms->n; t++) {
+		int root = terms->vertices[t];
+		if (disc[root] != -1) {
+			continue; // Component is done already
+		}
+		disc[root] = low[root] = time++;
+		parentEdge[root] = -1;
+		nextAdj[root] = g->offsets[root];
+		int top = 0;
+		dfsStack[0] = root;
+
+		while (top >= 0) {
+			int v = dfsStack[top];
+			if (nextAdj[v] < g->offsets[v+1]) {
+				int k = nextAdj[v]++;
+				int e = g->adjEdges[k];
+				int w = g->adjVertices[k];
+				if (e == parentEdge[v] || w == v) {
+					continue; // Parallel edges to the parent are back edges, loops are in no block
+				}
+				if (disc[w] == -1) {
+					disc[w] = low[w] = time++;
+					parentEdge[w] = e;
+					nextAdj[w] = g->offsets[w];
+					edgeStack[nEdgeStack++] = e;
+					dfsStack[++top] = w;
+				}
+				else if (disc[w] < disc[v]) {
+					edgeStack[nEdgeStack++] = e; // Back edge
+					if (disc[w] < low[v]) {
+						low[v] = disc[w];
+					}
+				}
+				continue;
+			}
+
+			// v is finished, its parent p separates the subtree of v if nothing in it reaches above p
+			top--;
+			if (top < 0) {
+				break;
+			}
+			int p = dfsStack[top];
+			if (low[v] < low[p]) {
+				low[p] = low[v];
+			}
+			if (low[v] >= disc[p]) {
+				int e;
+				do {
+					e = edgeStack[--nEdgeStack];
+					blockOf[e] = nBlocks;
+				} while (e != parentEdge[v]);
+				nBlocks++;
+			}
+		}
+	}
+
+	free(disc);
+	free(low);
+	free(parentEdge);
+	free(nextAdj);
+	free(dfsStack);
+	free(edgeStack);
+	return nBlocks;
+}
+
+// Collects the distinct vertices of block b, isCollected is all false before and after
+static int collectBlockVertices(int b, int *blockStarts, int *blockEdges, bool *isCollected, int *vertices, Graph *g) {
+	int nVertices = 0;
+	for (int j = blockStarts[b]; j < blockStarts[b+1]; j++) {
+		Edge e = g->edges[blockEdges[j]];
+		int ends[2] = {e.v, e.w};
+		for (int k = 0; k < 2; k++) {
+			if (!isCollected[ends[k]]) {
+				isCollected[ends[k]] = true;
+				vertices[nVertices] = ends[k];
+				nVertices++;
+			}
+		}
+	}
+	for (int i = 0; i < nVertices; i++) {
+		isCollected[vertices[i]] = false;
+	}
+	return nVertices;
+}
+
+// Removes nodes of the block-cut forest without terminals from its leaves inwards,
+// the remaining nodes form the minimal subtrees connecting the terminals
+static bool *pruneBlockCutForest(int nNodes, int *offsets, int *adj, int *nTerminals) {
+	bool *isRemoved = calloc(nNodes, sizeof(bool));
+	int *degree = calloc(nNodes, sizeof(int));
+	int *queue = calloc(nNodes, sizeof(int));
+	int nQueue = 0;
+	for (int x = 0; x < nNodes; x++) {
+		degree[x] = offsets[x+1] - offsets[x];
+		if (nTerminals[x] == 0 && degree[x] <= 1) {
+			isRemoved[x] = true;
+			queue[nQueue++] = x;
+		}
+	}
+	for (int q = 0; q < nQueue; q++) {
+		int x = queue[q];
+		for (int k = offsets[x]; k < offsets[x+1]; k++) {
+			int y = adj[k];
+			degree[y]--;
+			if (!isRemoved[y] && nTerminals[y] == 0 && degree[y] <= 1) {
+				isRemoved[y] = true;
+				queue[nQueue++] = y;
+			}
+		}
+	}
+	free(degree);
+	free(queue);
+	return isRemoved;
+}
+
+static InducedSubGraph createBlockGraph(int *vertices, int nVertices, int *edges, int nEdges, int *oldIDtoNewID, Graph *g) {
+	InducedSubGraph block;
+	block.newIDtoOldID = calloc(nVertices, sizeof(int));
+	block.origEdgeI = calloc(nEdges, sizeof(int));
+	for (int i = 0; i < nVertices; i++) {
+		block.newIDtoOldID[i] = vertices[i];
+		oldIDtoNewID[vertices[i]] = i;
+	}
+	block.graph = createGraph(nVertices, nEdges);
+	for (int j = 0; j < nEdges; j++) {
+		Edge e = g->edges[edges[j]];
+		addEdge(oldIDtoNewID[e.v], oldIDtoNewID[e.w], e.cost, j, block.graph);
+		block.origEdgeI[j] = edges[j];
+	}
+	buildAdjacency(block.graph);
+	return block;
+}
+
+BlockDecomposition decomposeIntoBlocks(Graph *g, Terminals *terms) {
+	int *blockOf = calloc(g->m + 1, sizeof(int));
+	int nAllBlocks = findBlocks(g, terms, blockOf);
+
+	// Edges sorted by block
+	int *blockStarts = calloc(nAllBlocks + 1, sizeof(int));
+	int *blockEdges = calloc(g->m + 1, sizeof(int));
+	for (int i = 0; i < g->m; i++) {
+		if (blockOf[i] != -1) {
+			blockStarts[blockOf[i] + 1]++;
+		}
+	}
+	for (int b = 0; b < nAllBlocks; b++) {
+		blockStarts[b+1] += blockStarts[b];
+	}
+	int *nextPos = calloc(nAllBlocks + 1, sizeof(int));
+	for (int b = 0; b < nAllBlocks; b++) {
+		nextPos[b] = blockStarts[b];
+	}
+	for (int i = 0; i < g->m; i++) {
+		if (blockOf[i] != -1) {
+			blockEdges[nextPos[blockOf[i]]++] = i;
+		}
+	}
+	free(nextPos);
+
+	// Vertices in more than one block are articulation vertices
+	bool *isCollected = calloc(g->n, sizeof(bool));
+	int *nBlocksOf = calloc(g->n, sizeof(int));
+	int *vertices = calloc(g->n, sizeof(int));
+	int nIncidences = 0;
+	for (int b = 0; b < nAllBlocks; b++) {
+		int nVertices = collectBlockVertices(b, blockStarts, blockEdges, isCollected, vertices, g);
+		for (int i = 0; i < nVertices; i++) {
+			nBlocksOf[vertices[i]]++;
+		}
+		nIncidences += nVertices;
+	}
+	int *cutIndex = calloc(g->n, sizeof(int));
+	int nCuts = 0;
+	for (int v = 0; v < g->n; v++) {
+		cutIndex[v] = (nBlocksOf[v] >= 2) ? nCuts++ : -1;
+	}
+
+	// Block-cut forest: node b for block b, node nAllBlocks + cutIndex[v] for articulation vertex v
+	int nNodes = nAllBlocks + nCuts;
+	int *nodeOffsets = calloc(nNodes + 1, sizeof(int));
+	int *nodeAdj = calloc(2 * nIncidences + 1, sizeof(int));
+	int *nodeTerminals = calloc(nNodes, sizeof(int));
+	for (int v = 0; v < g->n; v++) {
+		if (cutIndex[v] != -1) {
+			nodeOffsets[nAllBlocks + cutIndex[v] + 1] = nBlocksOf[v];
+		}
+	}
+	for (int b = 0; b < nAllBlocks; b++) {
+		int nVertices = collectBlockVertices(b, blockStarts, blockEdges, isCollected, vertices, g);
+		for (int i = 0; i < nVertices; i++) {
+			if (cutIndex[vertices[i]] != -1) {
+				nodeOffsets[b+1]++;
+			}
+		}
+	}
+	for (int x = 0; x < nNodes; x++) {
+		nodeOffsets[x+1] += nodeOffsets[x];
+	}
+	int *nodeFill = calloc(nNodes, sizeof(int));
+	for (int b = 0; b < nAllBlocks; b++) {
+		int nVertices = collectBlockVertices(b, blockStarts, blockEdges, isCollected, vertices, g);
+		for (int i = 0; i < nVertices; i++) {
+			int v = vertices[i];
+			if (cutIndex[v] != -1) {
+				int c = nAllBlocks + cutIndex[v];
+				nodeAdj[nodeOffsets[b] + nodeFill[b]++] = c;
+				nodeAdj[nodeOffsets[c] + nodeFill[c]++] = b;
+			}
+		}
+	}
+	free(nodeFill);
+
+	bool *isTerminal = calloc(g->n, sizeof(bool));
+	for (int t = 0; t < terms->n; t++) {
+		int v = terms->vertices[t];
+		if (isTerminal[v]) {
+			continue;
+		}
+		isTerminal[v] = true;
+		if (cutIndex[v] != -1) {
+			nodeTerminals[nAllBlocks + cutIndex[v]]++;
+			continue;
+		}
+		// A terminal in a single block, isolated terminals are in none
+		for (int k = g->offsets[v]; k < g->offsets[v+1]; k++) {
+			if (blockOf[g->adjEdges[k]] != -1) {
+				nodeTerminals[blockOf[g->adjEdges[k]]]++;
+				break;
+			}
+		}
+	}
+	bool *isRemoved = pruneBlockCutForest(nNodes, nodeOffsets, nodeAdj, nodeTerminals);
+
+	// Kept blocks become instances with their terminals and the kept articulation vertices as terminals
+	BlockDecomposition bd;
+	bd.nBlocks = 0;
+	bd.blocks = calloc(nAllBlocks + 1, sizeof(InducedSubGraph));
+	bd.blockTerms = calloc(nAllBlocks + 1, sizeof(Terminals*));
+	bd.fixedEdges = calloc(nAllBlocks + 1, sizeof(int));
+	bd.nFixedEdges = 0;
+	int *oldIDtoNewID = calloc(g->n, sizeof(int));
+	int *blockTerminals = calloc(g->n, sizeof(int));
+	int nArticulationTerminals = 0;
+	int nKept = 0;
+	int maxBlockEdges = 0;
+	for (int b = 0; b < nAllBlocks; b++) {
+		if (isRemoved[b]) {
+			continue;
+		}
+		nKept++;
+		int nVertices = collectBlockVertices(b, blockStarts, blockEdges, isCollected, vertices, g);
+		int nBlockTerms = 0;
+		for (int i = 0; i < nVertices; i++) {
+			int v = vertices[i];
+			bool isKeptCut = cutIndex[v] != -1 && !isRemoved[nAllBlocks + cutIndex[v]];
+			if (isTerminal[v] || isKeptCut) {
+				blockTerminals[nBlockTerms] = v;
+				nBlockTerms++;
+				nArticulationTerminals += !isTerminal[v];
+			}
+		}
+		int nEdges = blockStarts[b+1] - blockStarts[b];
+		if (nBlockTerms <= 1) {
+			continue; // Nothing to connect
+		}
+		if (nEdges == 1) {
+			bd.fixedEdges[bd.nFixedEdges] = blockEdges[blockStarts[b]]; // Bridge between two terminals
+			bd.nFixedEdges++;
+			continue;
+		}
+		if (nEdges > maxBlockEdges) {
+			maxBlockEdges = nEdges;
+		}
+		InducedSubGraph block = createBlockGraph(vertices, nVertices, &blockEdges[blockStarts[b]], nEdges, oldIDtoNewID, g);
+		Terminals *blockTerms = calloc(1, sizeof(Terminals));
+		blockTerms->vertices = calloc(nBlockTerms, sizeof(int));
+		blockTerms->n = nBlockTerms;
+		for (int i = 0; i < nBlockTerms; i++) {
+			blockTerms->vertices[i] = oldIDtoNewID[blockTerminals[i]];
+		}
+		bd.blocks[bd.nBlocks] = block;
+		bd.blockTerms[bd.nBlocks] = blockTerms;
+		bd.nBlocks++;
+	}
+
+	addCount(COUNT_BLOCKS, nAllBlocks);
+	addCount(COUNT_KEPT_BLOCKS, nKept);
+	addCount(COUNT_SOLVED_BLOCKS, bd.nBlocks);
+	addCount(COUNT_ARTICULATION_TERMINALS, nArticulationTerminals);
+	addCount(COUNT_LARGEST_BLOCK_EDGES, maxBlockEdges);
+
+	free(blockOf);
+	free(blockStarts);
+	free(blockEdges);
+	free(isCollected);
+	free(nBlocksOf);
+	free(vertices);
+	free(cutIndex);
+	free(nodeOffsets);
+	free(nodeAdj);
+	free(nodeTerminals);
+	free(isTerminal);
+	free(isRemoved);
+	free(oldIDtoNewID);
+	free(blockTerminals);
+	return bd;
+}
+
+SteinerTree joinBlockSolutions(SteinerTree *blockTrees, BlockDecomposition bd) {
+	int nEdges = bd.nFixedEdges;
+	for (int b = 0; b < bd.nBlocks; b++) {
+		nEdges += blockTrees[b].n;
+	}
+
+	// Blocks share no edges, so the union of their trees is a forest joined at the articulation vertices
+	SteinerTree st;
+	st.treeEdgeIndices = calloc(nEdges + 1, sizeof(int));
+	st.n = 0;
+	for (int i = 0; i < bd.nFixedEdges; i++) {
+		st.treeEdgeIndices[st.n] = bd.fixedEdges[i];
+		st.n++;
+	}
+	for (int b = 0; b < bd.nBlocks; b++) {
+		for (int i = 0; i < blockTrees[b].n; i++) {
+			int edgeI = blockTrees[b].treeEdgeIndices[i];
+			if (edgeI != -1) {
+				st.treeEdgeIndices[st.n] = bd.blocks[b].origEdgeI[edgeI];
+				st.n++;
+			}
+		}
+	}
+	return st;
+}
+
+void freeBlockDecomposition(BlockDecomposition bd) {
+	for (int b = 0; b < bd.nBlocks; b++) {
+		freeInducedSubGraph(bd.blocks[b]);
+		freeTerminals(bd.blockTerms[b]);
+	}
+	free(bd.blocks);
+	free(bd.blockTerms);
+	free(bd.fixedEdges);
+}
@@ -0,0 +1,27 @@
+#ifndef BLOCKS_H
+#define BLOCKS_H
+
+#include "../structures/graph.h"
+#include "../utils.h"
+
+// Split of an instance at its articulation vertices into independently solvable blocks.
+// Components and blocks that are not on a path between terminals are dropped. Articulation vertices
+// between kept blocks become terminals of their blocks, so the union of the block trees is a Steiner tree.
+// Block i is blocks[i].graph with the terminals blockTerms[i], mapped back via newIDtoOldID and origEdgeI.
+// Kept blocks of a single edge are not solved, their edge is part of every Steiner tree.
+typedef struct {
+	int nBlocks;
+	InducedSubGraph *blocks;
+	Terminals **blockTerms;
+	int *fixedEdges;
+	int nFixedEdges;
+} BlockDecomposition;
+
+BlockDecomposition decomposeIntoBlocks(Graph *g, Terminals *terms);
+
+// Maps the trees of all blocks back to g and joins them with the fixed edges
+SteinerTree joinBlockSolutions(SteinerTree *blockTrees, BlockDecomposition bd);
+
+void freeBlockDecomposition(BlockDecomposition bd);
+
+#endif
@@ -0,0 +1,582 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <float.h>
+#include <omp.h>
+
+#include "reductions.h"
+#include "../algorithms/dijkstra/dijkstra.h"
+#include "../structures/prio-queue.h"
+#include "../structures/union-find.h"
+#include "../structures/buffer.h"
+#include "../stats.h"
+
+#define MAX_REDUCTION_ROUNDS 10
+#define LONG_EDGE_SCAN_LIMIT 100 // Edges a search of the long edge test may scan, it keeps the edge beyond
+
+// Mutable copy of the graph the tests work on.
+// Vertex IDs stay the original ones, removed and contracted vertices are just left isolated.
+// Edges 0..nOrigEdges-1 are the original edges, later edges replace a path over a degree-2 vertex
+// and refer to the two edges they were merged from.
+// Incidences are singly linked lists of edge ends (2*edgeI is the end at v, 2*edgeI+1 the end at w),
+// deleted edges are unlinked lazily when a list is walked.
+typedef struct {
+	int n;
+	int m;
+	int cap;
+	int nOrigEdges;
+	Edge *edges;
+	bool *isDeleted;
+	int *mergedFrom;
+	int *head;
+	int *next;
+	int *degrees;
+	bool *isTerminal;
+	int nTerminals;
+	Buffer *fixedEdges;
+	int *stack; // Vertices whose degree changed and have to be tested again
+	int nStack;
+	bool *inStack;
+} WorkGraph;
+
+static int otherEndVertex(int end, WorkGraph *wg) {
+	Edge e = wg->edges[end / 2];
+	return (end % 2 == 0) ? e.w : e.v;
+}
+
+static void pushVertex(int v, WorkGraph *wg) {
+	if (!wg->inStack[v]) {
+		wg->inStack[v] = true;
+		wg->stack[wg->nStack] = v;
+		wg->nStack++;
+	}
+}
+
+static int addWorkEdge(int v, int w, double cost, int mergedA, int mergedB, WorkGraph *wg) {
+	if (wg->m >= wg->cap) {
+		wg->cap *= 2;
+		wg->edges = realloc(wg->edges, wg->cap * sizeof(Edge));
+		wg->isDeleted = realloc(wg->isDeleted, wg->cap * sizeof(bool));
+		wg->mergedFrom = realloc(wg->mergedFrom, 2 * wg->cap * sizeof(int));
+		wg->next = realloc(wg->next, 2 * wg->cap * sizeof(int));
+	}
+	int i = wg->m;
+	wg->m++;
+
+	wg->edges[i] = (Edge){v, w, cost};
+	wg->isDeleted[i] = false;
+	wg->mergedFrom[2*i] = mergedA;
+	wg->mergedFrom[2*i + 1] = mergedB;
+
+	wg->next[2*i] = wg->head[v];
+	wg->head[v] = 2*i;
+	wg->next[2*i + 1] = wg->head[w];
+	wg->head[w] = 2*i + 1;
+	wg->degrees[v]++;
+	wg->degrees[w]++;
+	return i;
+}
+
+static void deleteWorkEdge(int i, WorkGraph *wg) {
+	Edge e = wg->edges[i];
+	wg->isDeleted[i] = true;
+	wg->degrees[e.v]--;
+	wg->degrees[e.w]--;
+	pushVertex(e.v, wg);
+	pushVertex(e.w, wg);
+}
+
+// Unlinks deleted edges, so the list of v holds exactly degrees[v] ends afterwards
+static void compactIncidences(int v, WorkGraph *wg) {
+	int *link = &wg->head[v];
+	while (*link != -1) {
+		int end = *link;
+		if (wg->isDeleted[end / 2]) {
+			*link = wg->next[end];
+		}
+		else {
+			link = &wg->next[end];
+		}
+	}
+}
+
+static WorkGraph *createWorkGraph(Graph *g, Terminals *terms) {
+	WorkGraph *wg = calloc(1, sizeof(WorkGraph));
+	wg->n = g->n;
+	wg->cap = (g->m > 0) ? 2 * g->m : 1;
+	wg->nOrigEdges = g->m;
+	wg->edges = calloc(wg->cap, sizeof(Edge));
+	wg->isDeleted = calloc(wg->cap, sizeof(bool));
+	wg->mergedFrom = calloc(2 * wg->cap, sizeof(int));
+	wg->next = calloc(2 * wg->cap, sizeof(int));
+	wg->head = calloc(g->n, sizeof(int));
+	wg->degrees = calloc(g->n, sizeof(int));
+	wg->isTerminal = calloc(g->n, sizeof(bool));
+	wg->fixedEdges = createBuffer(sizeof(int));
+	wg->stack = calloc(g->n, sizeof(int));
+	wg->inStack = calloc(g->n, sizeof(bool));
+
+	for (int v = 0; v < g->n; v++) {
+		wg->head[v] = -1;
+	}
+	for (int i = 0; i < g->m; i++) {
+		Edge e = g->edges[i];
+		addWorkEdge(e.v, e.w, e.cost, -1, -1, wg);
+		if (e.v == e.w) {
+			deleteWorkEdge(i, wg); // Self-loops are never part of a tree
+		}
+	}
+	for (int i = 0; i < terms->n; i++) {
+		if (!wg->isTerminal[terms->vertices[i]]) {
+			wg->isTerminal[terms->vertices[i]] = true;
+			wg->nTerminals++;
+		}
+	}
+	for (int v = 0; v < g->n; v++) {
+		pushVertex(v, wg);
+	}
+	return wg;
+}
+
+static void freeWorkGraph(WorkGraph *wg) {
+	free(wg->edges);
+	free(wg->isDeleted);
+	free(wg->mergedFrom);
+	free(wg->next);
+	free(wg->head);
+	free(wg->degrees);
+	free(wg->isTerminal);
+	freeBuffer(wg->fixedEdges);
+	free(wg->stack);
+	free(wg->inStack);
+	free(wg);
+}
+
+// Adds edge i to the solution and merges terminal t into the other endpoint u of the edge
+static void contractTerminal(int t, int i, int u, WorkGraph *wg) {
+	appendToBuffer(wg->fixedEdges, &i);
+	deleteWorkEdge(i, wg);
+	compactIncidences(t, wg);
+
+	int last = -1;
+	for (int end = wg->head[t]; end != -1; end = wg->next[end]) {
+		if (otherEndVertex(end, wg) == u) {
+			deleteWorkEdge(end / 2, wg); // Parallel edge would become a self-loop
+		}
+		else {
+			// Reconnect the edge to u
+			Edge *e = &wg->edges[end / 2];
+			if (end % 2 == 0) {
+				e->v = u;
+			}
+			else {
+				e->w = u;
+			}
+			wg->degrees[t]--;
+			wg->degrees[u]++;
+		}
+		last = end;
+	}
+	if (last != -1) {
+		// Move the incidence list of t in front of the one of u
+		wg->next[last] = wg->head[u];
+		wg->head[u] = wg->head[t];
+		wg->head[t] = -1;
+	}
+
+	wg->isTerminal[t] = false;
+	if (wg->isTerminal[u]) {
+		wg->nTerminals--;
+	}
+	else {
+		wg->isTerminal[u] = true;
+	}
+	pushVertex(u, wg);
+}
+
+static void reduceVertex(int v, WorkGraph *wg) {
+	int degree = wg->degrees[v];
+	if (wg->nTerminals <= 1 || degree == 0 || (!wg->isTerminal[v] && degree > 2)) {
+		return;
+	}
+	compactIncidences(v, wg);
+	int first = wg->head[v];
+
+	if (!wg->isTerminal[v]) {
+		if (degree == 1) {
+			// Non-terminal leaf is never part of a min ST
+			deleteWorkEdge(first / 2, wg);
+			return;
+		}
+		int second = wg->next[first];
+		int a = otherEndVertex(first, wg);
+		int b = otherEndVertex(second, wg);
+		if (a != b) {
+			// Non-terminal of degree 2 is either passed through or not used, replace it by one edge
+			double cost = wg->edges[first / 2].cost + wg->edges[second / 2].cost;
+			addWorkEdge(a, b, cost, first / 2, second / 2, wg);
+		}
+		deleteWorkEdge(first / 2, wg);
+		deleteWorkEdge(second / 2, wg);
+		return;
+	}
+
+	int cheapest = first;
+	for (int end = wg->next[first]; end != -1; end = wg->next[end]) {
+		if (wg->edges[end / 2].cost < wg->edges[cheapest / 2].cost) {
+			cheapest = end;
+		}
+	}
+	int u = otherEndVertex(cheapest, wg);
+	if (degree == 1 || wg->isTerminal[u]) {
+		// A leaf terminal needs its edge, and the cheapest edge of a terminal is in some min ST
+		// if it leads to another terminal (short edge test)
+		contractTerminal(v, cheapest / 2, u, wg);
+	}
+}
+
+static void runDegreeTests(WorkGraph *wg) {
+	while (wg->nStack > 0) {
+		wg->nStack--;
+		int v = wg->stack[wg->nStack];
+		wg->inStack[v] = false;
+		reduceVertex(v, wg);
+	}
+}
+
+static void removeParallelEdges(WorkGraph *wg) {
+	int *edgeTo = calloc(wg->n, sizeof(int));
+	for (int v = 0; v < wg->n; v++) {
+		edgeTo[v] = -1;
+	}
+	for (int v = 0; v < wg->n; v++) {
+		if (wg->degrees[v] < 2) {
+			continue;
+		}
+		compactIncidences(v, wg);
+		for (int end = wg->head[v]; end != -1; end = wg->next[end]) {
+			int i = end / 2;
+			int w = otherEndVertex(end, wg);
+			if (wg->isDeleted[i]) {
+				continue;
+			}
+			if (edgeTo[w] == -1) {
+				edgeTo[w] = i;
+			}
+			else if (wg->edges[i].cost < wg->edges[edgeTo[w]].cost) {
+				deleteWorkEdge(edgeTo[w], wg);
+				edgeTo[w] = i;
+			}
+			else {
+				deleteWorkEdge(i, wg);
+			}
+		}
+		for (int end = wg->head[v]; end != -1; end = wg->next[end]) {
+			edgeTo[otherEndVertex(end, wg)] = -1;
+		}
+	}
+	free(edgeTo);
+}
+
+// Static graph of the remaining edges to run the distance based tests on
+static Graph *createSnapshot(WorkGraph *wg, int *workEdgeIndices) {
+	int nEdges = 0;
+	for (int i = 0; i < wg->m; i++) {
+		if (!wg->isDeleted[i]) {
+			nEdges++;
+		}
+	}
+	Graph *g = createGraph(wg->n, nEdges);
+	nEdges = 0;
+	for (int i = 0; i < wg->m; i++) {
+		if (!wg->isDeleted[i]) {
+			Edge e = wg->edges[i];
+			addEdge(e.v, e.w, e.cost, nEdges, g);
+			workEdgeIndices[nEdges] = i;
+			nEdges++;
+		}
+	}
+	buildAdjacency(g);
+	return g;
+}
+
+static int compareEdgeCosts(const void *a, const void *b) {
+	double costA = ((const Edge*)a)->cost;
+	double costB = ((const Edge*)b)->cost;
+	return (costA > costB) - (costA < costB);
+}
+
+static int comparePairValues(const void *a, const void *b) {
+	double valueA = ((const Pair*)a)->value;
+	double valueB = ((const Pair*)b)->value;
+	return (valueA > valueB) - (valueA < valueB);
+}
+
+// Bottleneck Steiner distance test: an edge that is more expensive than the longest terminal-free
+// segment on some other path between its endpoints is not part of any min ST.
+// Paths go from v to its nearest terminal, over the terminals connected by cheaper boundary paths
+// of the Voronoi regions, and from the nearest terminal of w to w.
+static int runBottleneckTest(Graph *g, WorkGraph *wg, bool *removeEdges) {
+	int *terminals = calloc(wg->nTerminals, sizeof(int));
+	int nTerminals = 0;
+	for (int v = 0; v < wg->n; v++) {
+		if (wg->isTerminal[v]) {
+			terminals[nTerminals] = v;
+			nTerminals++;
+		}
+	}
+	PathsData *pd = createPathsData(g->n);
+	multiDijkstra(terminals, nTerminals, pd, g);
+	int *bases = findNearestSources(pd, g);
+
+	// Boundary paths between neighboring Voronoi regions and the graph edges, both sorted by cost
+	Edge *terminalEdges = calloc(g->m, sizeof(Edge));
+	Pair *sortedEdges = calloc(g->m, sizeof(Pair));
+	int nTerminalEdges = 0;
+	for (int i = 0; i < g->m; i++) {
+		Edge e = g->edges[i];
+		sortedEdges[i] = (Pair){i, e.cost};
+		if (bases[e.v] >= 0 && bases[e.w] >= 0 && bases[e.v] != bases[e.w]) {
+			double cost = getDist(e.v, pd) + e.cost + getDist(e.w, pd);
+			terminalEdges[nTerminalEdges] = (Edge){bases[e.v], bases[e.w], cost};
+			nTerminalEdges++;
+		}
+	}
+	qsort(terminalEdges, nTerminalEdges, sizeof(Edge), compareEdgeCosts);
+	qsort(sortedEdges, g->m, sizeof(Pair), comparePairValues);
+
+	// Terminals in one set are connected by segments strictly cheaper than the current edge
+	UnionFind *uf = createUnionFind(g->n);
+	int nRemoved = 0;
+	int j = 0;
+	for (int k = 0; k < g->m; k++) {
+		int i = sortedEdges[k].key;
+		Edge e = g->edges[i];
+		while (j < nTerminalEdges && terminalEdges[j].cost < e.cost) {
+			unionSet(uf, terminalEdges[j].v, terminalEdges[j].w);
+			j++;
+		}
+		// Segments using e itself are at least as expensive as e, so they never pass the test
+		if (bases[e.v] >= 0 && bases[e.w] >= 0 && getDist(e.v, pd) < e.cost && getDist(e.w, pd) < e.cost
+				&& findSet(uf, bases[e.v]) == findSet(uf, bases[e.w])) {
+			removeEdges[i] = true;
+			nRemoved++;
+		}
+	}
+
+	freeUnionFind(uf);
+	free(sortedEdges);
+	free(terminalEdges);
+	free(bases);
+	freePathsData(pd);
+	free(terminals);
+	return nRemoved;
+}
+
+// Long edge test: an edge with a strictly shorter path between its endpoints is not part of any min ST
+static int runLongEdgeTest(Graph *g, bool *removeEdges) {
+	int nRemoved = 0;
+	int nThreads = omp_get_max_threads();
+	PathsData **pathsDatas = createMultiPathDatas(nThreads, g->n);
+
+	#pragma omp parallel for schedule(dynamic) reduction(+:nRemoved)
+	for (int i = 0; i < g->m; i++) {
+		if (removeEdges[i]) {
+			continue;
+		}
+		int tID = omp_get_thread_num();
+		Edge e = g->edges[i];
+
+		// Only paths shorter than the edge matter, so stop at its cost or once e.w is settled.
+		// A search that hits the scan limit may miss a shorter path, so the edge is kept then.
+		SearchLimits limits = noSearchLimits();
+		limits.maxDist = e.cost;
+		limits.target = e.w;
+		limits.maxScannedEdges = LONG_EDGE_SCAN_LIMIT;
+		limitedMultiDijkstra(&e.v, 1, limits, pathsDatas[tID], g);
+
+		if (getDist(e.w, pathsDatas[tID]) < e.cost) {
+			removeEdges[i] = true;
+			nRemoved++;
+		}
+		cleanPathsData(pathsDatas[tID]);
+	}
+
+	freeMultiPathsDatas(pathsDatas, nThreads);
+	return nRemoved;
+}
+
+static int runDistanceTests(WorkGraph *wg) {
+	int *workEdgeIndices = calloc(wg->m + 1, sizeof(int));
+	Graph *g = createSnapshot(wg, workEdgeIndices);
+	bool *removeEdges = calloc(g->m + 1, sizeof(bool));
+
+	// Both tests only remove edges that are in no min ST of the snapshot, so they can be applied together
+	int nRemoved = runBottleneckTest(g, wg, removeEdges);
+	nRemoved += runLongEdgeTest(g, removeEdges);
+
+	for (int i = 0; i < g->m; i++) {
+		if (removeEdges[i]) {
+			deleteWorkEdge(workEdgeIndices[i], wg);
+		}
+	}
+
+	free(removeEdges);
+	freeGraph(g);
+	free(workEdgeIndices);
+	return nRemoved;
+}
+
+// Writes the original edges that work edge i stands for to out, returns the new end of out
+static int expandWorkEdge(int i, WorkGraph *wg, int *stack, int *out, int nOut) {
+	int nStack = 0;
+	stack[nStack++] = i;
+	while (nStack > 0) {
+		int j = stack[--nStack];
+		if (j < wg->nOrigEdges) {
+			out[nOut] = j;
+			nOut++;
+		}
+		else {
+			stack[nStack++] = wg->mergedFrom[2*j];
+			stack[nStack++] = wg->mergedFrom[2*j + 1];
+		}
+	}
+	return nOut;
+}
+
+static ReducedInstance createReducedInstance(WorkGraph *wg) {
+	ReducedInstance ri;
+
+	// Keep terminals and vertices with remaining edges
+	int *oldIDtoNewID = calloc(wg->n, sizeof(int));
+	ri.newIDtoOldID = calloc(wg->n, sizeof(int));
+	int nVertices = 0;
+	for (int v = 0; v < wg->n; v++) {
+		oldIDtoNewID[v] = -1;
+		if (wg->degrees[v] > 0 || wg->isTerminal[v]) {
+			oldIDtoNewID[v] = nVertices;
+			ri.newIDtoOldID[nVertices] = v;
+			nVertices++;
+		}
+	}
+
+	ri.terms = calloc(1, sizeof(Terminals));
+	ri.terms->vertices = calloc(wg->nTerminals, sizeof(int));
+	for (int v = 0; v < wg->n; v++) {
+		if (wg->isTerminal[v]) {
+			ri.terms->vertices[ri.terms->n] = oldIDtoNewID[v];
+			ri.terms->n++;
+		}
+	}
+
+	int nEdges = 0;
+	for (int i = 0; i < wg->m; i++) {
+		if (!wg->isDeleted[i]) {
+			nEdges++;
+		}
+	}
+	ri.graph = createGraph(nVertices, nEdges);
+	ri.edgeMapOffsets = calloc(nEdges+1, sizeof(int));
+	// Every original edge is represented at most once
+	ri.edgeMap = calloc(wg->nOrigEdges + 1, sizeof(int));
+	int *stack = calloc(wg->m + 1, sizeof(int));
+
+	int edgeI = 0;
+	int nMapped = 0;
+	for (int i = 0; i < wg->m; i++) {
+		if (!wg->isDeleted[i]) {
+			Edge e = wg->edges[i];
+			addEdge(oldIDtoNewID[e.v], oldIDtoNewID[e.w], e.cost, edgeI, ri.graph);
+			ri.edgeMapOffsets[edgeI] = nMapped;
+			nMapped = expandWorkEdge(i, wg, stack, ri.edgeMap, nMapped);
+			edgeI++;
+		}
+	}
+	ri.edgeMapOffsets[nEdges] = nMapped;
+	buildAdjacency(ri.graph);
+
+	ri.fixedEdges = calloc(wg->nOrigEdges + 1, sizeof(int));
+	ri.nFixedEdges = 0;
+	int *fixed = (int*)wg->fixedEdges->data;
+	for (int k = 0; k < wg->fixedEdges->n; k++) {
+		ri.nFixedEdges = expandWorkEdge(fixed[k], wg, stack, ri.fixedEdges, ri.nFixedEdges);
+	}
+
+	free(stack);
+	free(oldIDtoNewID);
+	return ri;
+}
+
+ReducedInstance reduceInstance(Graph *g, Terminals *terms) {
+	WorkGraph *wg = createWorkGraph(g, terms);
+
+	int nRounds = 0;
+	while (nRounds < MAX_REDUCTION_ROUNDS) {
+		nRounds++;
+		removeParallelEdges(wg);
+		runDegreeTests(wg);
+		if (wg->nTerminals <= 1 || runDistanceTests(wg) == 0) {
+			break;
+		}
+	}
+	runDegreeTests(wg);
+
+	if (wg->nTerminals <= 1) {
+		// Single terminal left, the fixed edges already form the tree
+		for (int i = 0; i < wg->m; i++) {
+			if (!wg->isDeleted[i]) {
+				deleteWorkEdge(i, wg);
+			}
+		}
+		wg->nStack = 0;
+	}
+
+	ReducedInstance ri = createReducedInstance(wg);
+
+	addCount(COUNT_REDUCED_EDGES, g->m - ri.graph->m);
+	addCount(COUNT_REDUCED_VERTICES, g->n - ri.graph->n);
+	addCount(COUNT_FIXED_EDGES, ri.nFixedEdges);
+	addCount(COUNT_REDUCTION_ROUNDS, nRounds);
+
+	freeWorkGraph(wg);
+	return ri;
+}
+
+SteinerTree liftSolution(SteinerTree st, ReducedInstance ri) {
+	int nEdges = ri.nFixedEdges;
+	for (int i = 0; i < st.n; i++) {
+		int edgeI = st.treeEdgeIndices[i];
+		if (edgeI != -1) {
+			nEdges += ri.edgeMapOffsets[edgeI+1] - ri.edgeMapOffsets[edgeI];
+		}
+	}
+
+	SteinerTree lifted;
+	lifted.treeEdgeIndices = calloc(nEdges + 1, sizeof(int));
+	lifted.n = 0;
+	for (int i = 0; i < ri.nFixedEdges; i++) {
+		lifted.treeEdgeIndices[lifted.n] = ri.fixedEdges[i];
+		lifted.n++;
+	}
+	for (int i = 0; i < st.n; i++) {
+		int edgeI = st.treeEdgeIndices[i];
+		if (edgeI == -1) {
+			continue;
+		}
+		for (int j = ri.edgeMapOffsets[edgeI]; j < ri.edgeMapOffsets[edgeI+1]; j++) {
+			lifted.treeEdgeIndices[lifted.n] = ri.edgeMap[j];
+			lifted.n++;
+		}
+	}
+	return lifted;
+}
+
+void freeReducedInstance(ReducedInstance ri) {
+	freeGraph(ri.graph);
+	freeTerminals(ri.terms);
+	free(ri.newIDtoOldID);
+	free(ri.edgeMapOffsets);
+	free(ri.edgeMap);
+	free(ri.fixedEdges);
+}
@@ -0,0 +1,26 @@
+#ifndef REDUCTIONS_H
+#define REDUCTIONS_H
+
+#include "../structures/graph.h"
+#include "../utils.h"
+
+// Instance left after the reduction tests with compacted vertex IDs.
+// Reduced edge i stands for the original edges at positions [edgeMapOffsets[i], edgeMapOffsets[i+1]) of edgeMap.
+// Fixed edges are original edges that are part of a min ST in any case.
+typedef struct {
+	Graph *graph;
+	Terminals *terms;
+	int *newIDtoOldID;
+	int *edgeMapOffsets;
+	int *edgeMap;
+	int *fixedEdges;
+	int nFixedEdges;
+} ReducedInstance;
+
+ReducedInstance reduceInstance(Graph *g, Terminals *terms);
+
+SteinerTree liftSolution(SteinerTree st, ReducedInstance ri);
+
+void freeReducedInstance(ReducedInstance ri);
+
+#endif
@@ -0,0 +1,97 @@
+#include <time.h>
+#include <omp.h>
+#include <sys/resource.h>
+
+#include "stats.h"
+
+bool statsEnabled = false;
+
+static const char *phaseNames[N_PHASES] = {
+	"load", "reduce", "decompose", "solve", "local_search",
+	"closure", "closure_mst", "collect_paths", "prune",
+	"tm_search", "tm_add_path",
+	"ilp_build", "warm_start", "ilp_solve", "ilp_extract"
+};
+
+static const char *counterNames[N_COUNTERS] = {
+	"reduced_edges", "reduced_vertices", "fixed_edges", "reduction_rounds",
+	"local_search_moves", "local_search_rounds", "separated_cuts",
+	"blocks", "kept_blocks", "solved_blocks", "articulation_terminals", "largest_block_edges",
+	"td_solved", "td_over_state_cap", "td_nodes", "td_states", "td_max_width"
+};
+
+static double phaseSeconds[N_PHASES];
+static long long phaseCalls[N_PHASES];
+static double startTime;
+
+static long long nDijkstraCalls;
+static long long nPushes;
+static long long nPops;
+static long long nRelaxed;
+static long long counterValues[N_COUNTERS];
+
+static double monotonicTime(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void enableStats(void) {
+	statsEnabled = true;
+	startTime = monotonicTime();
+}
+
+double phaseStartTime(void) {
+	if (omp_in_parallel()) {
+		return 0;
+	}
+	return monotonicTime();
+}
+
+void addPhaseTime(Phase phase, double start) {
+	phaseSeconds[phase] += monotonicTime() - start;
+	phaseCalls[phase]++;
+}
+
+void addSearchCounts(bool isDijkstra, long pushes, long pops, long relaxed) {
+	// Searches run in parallel in the metric closure, the parallel heuristics and the reductions
+	if (isDijkstra) {
+		#pragma omp atomic
+		nDijkstraCalls++;
+	}
+	#pragma omp atomic
+	nPushes += pushes;
+	#pragma omp atomic
+	nPops += pops;
+	#pragma omp atomic
+	nRelaxed += relaxed;
+}
+
+void addCounterValue(Counter counter, long value) {
+	// Blocks are solved in parallel
+	#pragma omp atomic
+	counterValues[counter] += value;
+}
+
+void raiseCounterValue(Counter counter, long value) {
+	#pragma omp critical(raiseCounter)
+	if (value > counterValues[counter]) {
+		counterValues[counter] = value;
+	}
+}
+
+void printStats(FILE *out) {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage); // ru_maxrss is in KiB on Linux
+
+	fprintf(out, "{\"total_seconds\": %.6f, \"threads\": %d, \"phases\": {", monotonicTime() - startTime, omp_get_max_threads());
+	for (int p = 0; p < N_PHASES; p++) {
+		fprintf(out, "%s\"%s\": {\"seconds\": %.6f, \"calls\": %lld}", (p > 0) ? ", " : "", phaseNames[p], phaseSeconds[p], phaseCalls[p]);
+	}
+	fprintf(out, "}, \"counters\": {");
+	for (int c = 0; c < N_COUNTERS; c++) {
+		fprintf(out, "%s\"%s\": %lld", (c > 0) ? ", " : "", counterNames[c], counterValues[c]);
+	}
+	fprintf(out, "}, \"dijkstra_calls\": %lld, \"heap_pushes\": %lld, \"heap_pops\": %lld, \"edges_relaxed\": %lld, \"peak_rss_kib\": %ld}\n",
+		nDijkstraCalls, nPushes, nPops, nRelaxed, usage.ru_maxrss);
+}
@@ -0,0 +1,100 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+// Instrumentation of a run, enabled by -i and printed as one JSON line on stderr.
+// Disabled, every timer and counter call is a single branch on statsEnabled.
+
+typedef enum {
+	PHASE_LOAD,
+	PHASE_REDUCE,
+	PHASE_DECOMPOSE,
+	PHASE_SOLVE,
+	PHASE_LOCAL_SEARCH,
+	PHASE_CLOSURE,
+	PHASE_CLOSURE_MST,
+	PHASE_COLLECT_PATHS,
+	PHASE_PRUNE,
+	PHASE_TM_SEARCH,
+	PHASE_TM_ADD_PATH,
+	PHASE_ILP_BUILD,
+	PHASE_WARM_START,
+	PHASE_ILP_SOLVE,
+	PHASE_ILP_EXTRACT,
+	N_PHASES
+} Phase;
+
+// Results of the phases that are summed over all calls
+typedef enum {
+	COUNT_REDUCED_EDGES,
+	COUNT_REDUCED_VERTICES,
+	COUNT_FIXED_EDGES,
+	COUNT_REDUCTION_ROUNDS,
+	COUNT_LOCAL_SEARCH_MOVES,
+	COUNT_LOCAL_SEARCH_ROUNDS,
+	COUNT_SEPARATED_CUTS,
+	COUNT_BLOCKS,
+	COUNT_KEPT_BLOCKS,
+	COUNT_SOLVED_BLOCKS,
+	COUNT_ARTICULATION_TERMINALS,
+	COUNT_LARGEST_BLOCK_EDGES, // The decomposition runs once
+	COUNT_TD_SOLVED,
+	COUNT_TD_OVER_STATE_CAP,
+	COUNT_TD_NODES,
+	COUNT_TD_STATES,
+	COUNT_TD_MAX_WIDTH, // Maximum instead of sum, see raiseCount
+	N_COUNTERS
+} Counter;
+
+extern bool statsEnabled;
+
+void enableStats(void);
+
+// Current time of CLOCK_MONOTONIC in seconds, 0 inside parallel regions
+double phaseStartTime(void);
+
+void addPhaseTime(Phase phase, double start);
+
+void addSearchCounts(bool isDijkstra, long nPushes, long nPops, long nRelaxed);
+
+void addCounterValue(Counter counter, long value);
+
+void raiseCounterValue(Counter counter, long value);
+
+// Prints the phase times, counters and peak resident memory as JSON
+void printStats(FILE *out);
+
+// Timers only measure on the outermost thread, phases inside parallel regions would be counted per thread.
+// A phase is timed by double start = startPhase(); ... endPhase(PHASE_X, start);
+static inline double startPhase(void) {
+	return statsEnabled ? phaseStartTime() : 0;
+}
+
+static inline void endPhase(Phase phase, double start) {
+	if (statsEnabled && start > 0) {
+		addPhaseTime(phase, start);
+	}
+}
+
+// Dijkstra and Prim report their queue operations and relaxed edges once per call
+static inline void countSearch(bool isDijkstra, long nPushes, long nPops, long nRelaxed) {
+	if (statsEnabled) {
+		addSearchCounts(isDijkstra, nPushes, nPops, nRelaxed);
+	}
+}
+
+static inline void addCount(Counter counter, long value) {
+	if (statsEnabled) {
+		addCounterValue(counter, value);
+	}
+}
+
+static inline void raiseCount(Counter counter, long value) {
+	if (statsEnabled) {
+		raiseCounterValue(counter, value);
+	}
+}
+
+#endif
@@ -0,0 +1,36 @@
+#include <stdlib.h>
+
+#include "atomic-bitset.h"
+
+AtomicBitset *createAtomicBitset(int n) {
+	AtomicBitset *bits = calloc(1, sizeof(AtomicBitset));
+	bits->n = n;
+	bits->words = calloc(n / 64 + 1, sizeof(uint64_t));
+	return bits;
+}
+
+void freeAtomicBitset(AtomicBitset *bits) {
+	free(bits->words);
+	free(bits);
+}
+
+// Returns whether bit i was already set before
+bool testAndSetBit(int i, AtomicBitset *bits) {
+	uint64_t *word = &bits->words[i / 64];
+	uint64_t mask = (uint64_t)1 << (i % 64);
+
+	// Cheap read first, most calls hit bits that are already set
+	uint64_t old;
+	#pragma omp atomic read
+	old = *word;
+	if (old & mask) {
+		return true;
+	}
+
+	#pragma omp atomic capture
+	{
+		old = *word;
+		*word |= mask;
+	}
+	return (old & mask) != 0;
+}
@@ -0,0 +1,19 @@
+#ifndef ATOMICBITSET_H
+#define ATOMICBITSET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bitset which can be shared between OpenMP threads: setting a bit is an atomic test-and-set
+typedef struct {
+	int n;
+	uint64_t *words;
+} AtomicBitset;
+
+AtomicBitset *createAtomicBitset(int n);
+
+void freeAtomicBitset(AtomicBitset *bits);
+
+bool testAndSetBit(int i, AtomicBitset *bits);
+
+#endif
@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "bucket-queue.h"
+
+BucketQueue *createBucketQueue(int n, int nBuckets) {
+	BucketQueue *q = calloc(1, sizeof(BucketQueue));
+	q->n = n;
+	q->nBuckets = nBuckets;
+	q->values = calloc(n, sizeof(unsigned long long));
+	q->bucketOf = calloc(n, sizeof(int));
+	q->next = calloc(n, sizeof(int));
+	q->prev = calloc(n, sizeof(int));
+	q->heads = calloc(nBuckets + 1, sizeof(int));
+	q->farMin = ULLONG_MAX;
+	for (int i = 0; i < n; i++) {
+		q->bucketOf[i] = -1; // Not contained
+	}
+	for (int b = 0; b <= nBuckets; b++) {
+		q->heads[b] = -1;
+	}
+	return q;
+}
+
+void freeBucketQueue(BucketQueue *q) {
+	free(q->values);
+	free(q->bucketOf);
+	free(q->next);
+	free(q->prev);
+	free(q->heads);
+	free(q);
+}
+
+bool isEmptyBucketQueue(BucketQueue *q) {
+	return q->size == 0;
+}
+
+static void linkKey(int key, int b, BucketQueue *q) {
+	q->bucketOf[key] = b;
+	q->prev[key] = -1;
+	q->next[key] = q->heads[b];
+	if (q->heads[b] != -1) {
+		q->prev[q->heads[b]] = key;
+	}
+	q->heads[b] = key;
+}
+
+static void unlinkKey(int key, BucketQueue *q) {
+	int b = q->bucketOf[key];
+	if (q->prev[key] != -1) {
+		q->next[q->prev[key]] = q->next[key];
+	}
+	else {
+		q->heads[b] = q->next[key];
+	}
+	if (q->next[key] != -1) {
+		q->prev[q->next[key]] = q->prev[key];
+	}
+	q->bucketOf[key] = -1;
+}
+
+static void linkFar(int key, BucketQueue *q) {
+	linkKey(key, q->nBuckets, q);
+	q->nFar++;
+	if (q->values[key] < q->farMin) {
+		q->farMin = q->values[key];
+	}
+}
+
+// Puts key into the bucket of its value if that lies in the current window and below the far list
+static void place(int key, BucketQueue *q) {
+	unsigned long long v = q->values[key];
+	if (v - q->cur < (unsigned long long)q->nBuckets && v < q->farMin) {
+		linkKey(key, v % q->nBuckets, q);
+		if (v > q->maxBucketValue) {
+			q->maxBucketValue = v;
+		}
+	}
+	else {
+		linkFar(key, q);
+	}
+}
+
+// Moves the keys of the far list that fall into the window again into their buckets
+static void refillFromFar(BucketQueue *q) {
+	int key = q->heads[q->nBuckets];
+	q->heads[q->nBuckets] = -1;
+	q->nFar = 0;
+	q->farMin = ULLONG_MAX;
+	while (key != -1) {
+		int next = q->next[key];
+		place(key, q);
+		key = next;
+	}
+}
+
+// After cur moved back, values at the end of the old window may lie beyond the new one
+static void evictBeyondWindow(BucketQueue *q) {
+	q->maxBucketValue = q->cur;
+	for (int b = 0; b < q->nBuckets; b++) {
+		int key = q->heads[b];
+		while (key != -1) {
+			int next = q->next[key];
+			if (q->values[key] - q->cur >= (unsigned long long)q->nBuckets) {
+				unlinkKey(key, q);
+				linkFar(key, q);
+			}
+			else if (q->values[key] > q->maxBucketValue) {
+				q->maxBucketValue = q->values[key];
+			}
+			key = next;
+		}
+	}
+}
+
+void pushBucketQueue(int key, unsigned long long v, BucketQueue *q) {
+	if (q->bucketOf[key] != -1) {
+		if (v >= q->values[key]) {
+			return; // Not a decrease
+		}
+		if (q->bucketOf[key] == q->nBuckets) {
+			q->nFar--;
+		}
+		unlinkKey(key, q);
+		q->size--;
+	}
+	if (q->size == 0) {
+		q->cur = v;
+		q->maxBucketValue = v;
+		q->farMin = ULLONG_MAX;
+	}
+	else if (v < q->cur) {
+		q->cur = v;
+		if (q->maxBucketValue - v >= (unsigned long long)q->nBuckets) {
+			evictBeyondWindow(q);
+		}
+	}
+	q->values[key] = v;
+	place(key, q);
+	q->size++;
+}
+
+int extractMinBucketQueue(BucketQueue *q, unsigned long long *value) {
+	if (q->size == 0) {
+		fprintf(stderr, "Underflow in BucketQueue.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (q->size == q->nFar) {
+		// Buckets ran empty, the window restarts at the smallest far value
+		unsigned long long min = q->values[q->heads[q->nBuckets]];
+		for (int key = q->heads[q->nBuckets]; key != -1; key = q->next[key]) {
+			if (q->values[key] < min) {
+				min = q->values[key];
+			}
+		}
+		q->cur = min;
+		q->maxBucketValue = min;
+		refillFromFar(q);
+	}
+	int b = q->cur % q->nBuckets;
+	while (q->heads[b] == -1) {
+		q->cur++;
+		b++;
+		if (b == q->nBuckets) {
+			b = 0;
+		}
+	}
+	int key = q->heads[b];
+	unlinkKey(key, q);
+	q->size--;
+	*value = q->values[key];
+	return key;
+}
+
+void clearBucketQueue(BucketQueue *q) {
+	if (q->size == 0) {
+		return; // All lists are empty already
+	}
+	for (int b = 0; b <= q->nBuckets; b++) {
+		for (int key = q->heads[b]; key != -1; key = q->next[key]) {
+			q->bucketOf[key] = -1;
+		}
+		q->heads[b] = -1;
+	}
+	q->size = 0;
+	q->nFar = 0;
+	q->farMin = ULLONG_MAX;
+}
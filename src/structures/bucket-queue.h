@@ -0,0 +1,41 @@
+#ifndef BUCKETQUEUE_H
+#define BUCKETQUEUE_H
+
+#include <stdbool.h>
+
+// Dial's bucket queue over the keys 0..n-1 for non-negative integer values.
+// The nBuckets cyclic buckets hold the values in [cur, cur + nBuckets), larger values wait in a far list
+// until the buckets run empty, and all values in the buckets are below those in the far list.
+// With nBuckets > maximum edge cost, Dijkstra never uses the far list.
+// Values below cur move cur back, so Prim (whose values are edge costs) and extended searches work as well.
+// Each key is contained at most once, buckets are linked lists through next and prev.
+typedef struct {
+	int n;
+	int nBuckets;
+	int size;
+	int nFar;
+	unsigned long long cur;
+	unsigned long long maxBucketValue; // Upper bound of the values in the buckets
+	unsigned long long farMin; // Lower bound of the values in the far list
+	unsigned long long *values;
+	int *bucketOf; // nBuckets for the far list, -1 if not contained
+	int *next;
+	int *prev;
+	int *heads; // nBuckets + 1 lists, the last one is the far list
+} BucketQueue;
+
+BucketQueue *createBucketQueue(int n, int nBuckets);
+
+void freeBucketQueue(BucketQueue *q);
+
+bool isEmptyBucketQueue(BucketQueue *q);
+
+// Inserts key or lowers its value (a higher value is ignored)
+void pushBucketQueue(int key, unsigned long long value, BucketQueue *q);
+
+// Removes a key of minimum value and returns it, value receives its value
+int extractMinBucketQueue(BucketQueue *q, unsigned long long *value);
+
+void clearBucketQueue(BucketQueue *q);
+
+#endif
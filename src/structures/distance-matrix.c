@@ -0,0 +1,25 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <float.h>
+
+#include "distance-matrix.h"
+
+DistanceMatrix *createDistanceMatrix(int n) {
+	size_t nPairs = (size_t)n * (n > 0 ? n-1 : 0) / 2;
+	DistanceMatrix *dm = calloc(1, sizeof(DistanceMatrix));
+	dm->n = n;
+	dm->dist = calloc(nPairs + 1, sizeof(double));
+	if (dm->dist == NULL) {
+		fprintf(stderr, "Error: Could not allocate distance matrix for %d points.\n", n);
+		exit(EXIT_FAILURE);
+	}
+	for (size_t k = 0; k < nPairs; k++) {
+		dm->dist[k] = DBL_MAX;
+	}
+	return dm;
+}
+
+void freeDistanceMatrix(DistanceMatrix *dm) {
+	free(dm->dist);
+	free(dm);
+}
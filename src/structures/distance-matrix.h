@@ -0,0 +1,35 @@
+#ifndef DISTANCEMATRIX_H
+#define DISTANCEMATRIX_H
+
+#include <stddef.h>
+
+// Symmetric distances between n points, stored as flat upper triangle without the diagonal.
+// Row i holds the distances from i to i+1, ..., n-1 one after another. Unset pairs are DBL_MAX.
+typedef struct {
+	int n;
+	double *dist;
+} DistanceMatrix;
+
+DistanceMatrix *createDistanceMatrix(int n);
+
+void freeDistanceMatrix(DistanceMatrix *dm);
+
+// Position of the pair i < j in dist
+static inline size_t distanceIndex(int i, int j, int n) {
+	return (size_t)i * (2*(size_t)n - i - 1) / 2 + (j - i - 1);
+}
+
+static inline double getDistance(int i, int j, DistanceMatrix *dm) {
+	return i < j ? dm->dist[distanceIndex(i, j, dm->n)] : dm->dist[distanceIndex(j, i, dm->n)];
+}
+
+static inline void setDistance(int i, int j, double d, DistanceMatrix *dm) {
+	if (i < j) {
+		dm->dist[distanceIndex(i, j, dm->n)] = d;
+	}
+	else {
+		dm->dist[distanceIndex(j, i, dm->n)] = d;
+	}
+}
+
+#endif
@@ -1,36 +1,61 @@
 #include <stdlib.h>
 #include <stdio.h>
-#include <string.h>
+#include <limits.h>
+#include <sys/mman.h>
 
 #include "graph.h"
 
+#define MAX_EXACT_INTEGER 9007199254740992.0 // 2^53, larger integers are not all representable as double
+
 Graph *createGraph(int n, int m) {
 	Graph *g = calloc(1, sizeof(Graph));
-	Vertex *vertices = calloc(n, sizeof(Vertex));
 	Edge *edges = calloc(m, sizeof(Edge));
 
-	*g = (Graph){n, m, vertices, edges};
+	*g = (Graph){n, m, edges, NULL, NULL, NULL, NULL, NULL, 0, REAL_COSTS, 0, NULL};
 	return g;
 }
 
+Graph *createDoubledGraph(Graph *g) {
+	// Each undirected edge i becomes the arcs 2i and 2i+1
+	Graph *arcs = createGraph(g->n, 2 * g->m);
+	for (int i = 0; i < g->m; i++) {
+		Edge e = g->edges[i];
+		addEdge(e.v, e.w, e.cost, 2*i, arcs);
+		addEdge(e.w, e.v, e.cost, 2*i + 1, arcs);
+	}
+	buildAdjacency(arcs);
+	return arcs;
+}
+
 Edge *getEdge(int v, int edgeI, Graph *g) {
-	int globalEdgeI = g->vertices[v].edges[edgeI];
+	int globalEdgeI = g->adjEdges[g->offsets[v] + edgeI];
 	return &g->edges[globalEdgeI];
 }
 
 int getEdgeIndex(int v, int edgeI, Graph *g) {
-	return g->vertices[v].edges[edgeI];
+	return g->adjEdges[g->offsets[v] + edgeI];
+}
+
+int getDegree(int v, Graph *g) {
+	return g->offsets[v+1] - g->offsets[v];
 }
 
-void freeVertex(int id, Graph *g) {
-	free(g->vertices[id].edges);
+static void freeAdjacency(Graph *g) {
+	free(g->offsets);
+	free(g->adjVertices);
+	free(g->adjEdges);
+	free(g->adjCosts);
+	free(g->adjIntCosts);
 }
 
 void freeGraph(Graph *g) {
-	for (int i = 0; i < g->n; i++) {
-		freeVertex(i, g);
+	if (g->mapping != NULL) {
+		munmap(g->mapping, g->mappingSize);
+		free(g->adjIntCosts);
+		free(g);
+		return;
 	}
-	free(g->vertices);
+	freeAdjacency(g);
 	free(g->edges);
 	free(g);
 }
@@ -40,162 +65,143 @@ void freeTerminals(Terminals *terms) {
 	free(terms);
 }
 
-void pushEdge(int id, int edgeI, Graph *g) {
-	Vertex *vertex = &g->vertices[id];
-	if (vertex->capEdges == 0) {
-		vertex->capEdges = 100;
-		vertex->edges = calloc(100, sizeof(int));
-	}
-	if (vertex->deg == vertex->capEdges) {
-		vertex->capEdges *= 2;
-		vertex->edges = realloc(vertex->edges, vertex->capEdges * sizeof(int));
-	}
-	vertex->edges[vertex->deg] = edgeI;
-	vertex->deg++;
-}
-
 void addEdge(int v, int w, double cost, int edgeI, Graph *g) {
-	Edge *e = &g->edges[edgeI];
-	*e = (Edge){v, w, cost};
-	pushEdge(v, edgeI, g);
-	pushEdge(w, edgeI, g);
+	g->edges[edgeI] = (Edge){v, w, cost};
 }
 
-Sizes scanGraphStructure(FILE *file, char *line, int lineSize) {
-	fgets(line, lineSize, file); // Read header
-	
-	fgets(line, lineSize, file); // Read |V|
-	int n;
-	sscanf(line, "Nodes %d", &n);
+void buildAdjacency(Graph *g) {
+	freeAdjacency(g); // Rebuild from scratch if edges have changed
+	classifyCosts(g);
 
-	fgets(line, lineSize, file); // Read |E|
-	int m;
-	sscanf(line, "Edges %d", &m);
+	int *offsets = calloc(g->n + 1, sizeof(int));
+	int *adjVertices = calloc(2 * g->m, sizeof(int));
+	int *adjEdges = calloc(2 * g->m, sizeof(int));
+	double *adjCosts = NULL;
+	int *adjIntCosts = NULL;
+	if (g->costType == INT32_COSTS) {
+		adjIntCosts = calloc(2 * g->m, sizeof(int)); // Half the memory traffic of the searches
+	}
+	else {
+		adjCosts = calloc(2 * g->m, sizeof(double));
+	}
 
-	return (Sizes){n, m};
-}
+	// First pass: count degrees and compute the start of each adjacency
+	for (int i = 0; i < g->m; i++) {
+		offsets[g->edges[i].v + 1]++;
+		offsets[g->edges[i].w + 1]++;
+	}
+	for (int v = 0; v < g->n; v++) {
+		offsets[v+1] += offsets[v];
+	}
 
-Graph *scanGraph(FILE *file, Terminals *terms, bool doubleEdges) {
-	char line[256];
-	Sizes s = scanGraphStructure(file, line, sizeof(line));
-	if (doubleEdges) {
-		s.m *= 2;
+	// Second pass: place incidences in order of the edge indices
+	int *nextPos = calloc(g->n + 1, sizeof(int));
+	for (int v = 0; v < g->n; v++) {
+		nextPos[v] = offsets[v];
 	}
-	Graph *g = createGraph(s.n, s.m);
+	for (int i = 0; i < g->m; i++) {
+		Edge e = g->edges[i];
+
+		int posV = nextPos[e.v]++;
+		adjVertices[posV] = e.w;
+		adjEdges[posV] = i;
+
+		int posW = nextPos[e.w]++;
+		adjVertices[posW] = e.v;
+		adjEdges[posW] = i;
 
-	int v, w;
-	double cost;
-	int nEdge = 0;
-	while (fgets(line, sizeof(line), file)) {
-		if (strncmp(line, "END", 3) == 0) {
-			break;
+		if (adjIntCosts != NULL) {
+			adjIntCosts[posV] = (int)e.cost;
+			adjIntCosts[posW] = (int)e.cost;
 		}
-		sscanf(line, "E %d %d %lf", &v, &w, &cost);
-		// Data is 1-indexed
-		v--;
-		w--;
-
-		addEdge(v, w, cost, nEdge, g);
-		nEdge++;
-		if (doubleEdges) {
-			addEdge(w, v, cost, nEdge, g);
-			nEdge++;
+		else {
+			adjCosts[posV] = e.cost;
+			adjCosts[posW] = e.cost;
 		}
 	}
-	scanTerminals(file, terms);
-	return g;
-}
+	free(nextPos);
 
-void scanTerminals(FILE *file, Terminals *terms) {
-	char line[256];
-	int n = 0;
+	g->offsets = offsets;
+	g->adjVertices = adjVertices;
+	g->adjEdges = adjEdges;
+	g->adjCosts = adjCosts;
+	g->adjIntCosts = adjIntCosts;
+}
 
-	// Read lines until we find one that starts with "Terminals"
-	while (fgets(line, sizeof(line), file)) {
-		if (strncmp(line, "Terminals", 9) == 0) {
-			sscanf(line, "Terminals %d", &n);
-			break;
+void classifyCosts(Graph *g) {
+	bool isInteger = true;
+	g->maxCost = 0;
+	for (int i = 0; i < g->m; i++) {
+		double cost = g->edges[i].cost;
+		if (cost < 0 || cost >= MAX_EXACT_INTEGER || cost != (double)(long long)cost) {
+			isInteger = false;
+		}
+		if (cost > g->maxCost) {
+			g->maxCost = cost;
 		}
 	}
-	
-	int *terminals = calloc(n, sizeof(int));
-
-	for (int i = 0; i < n; i++) {
-		fgets(line, sizeof(line), file);
-		sscanf(line, "T %d", &terminals[i]);
-		terminals[i]--; // Data is 1-indexed
+	// A simple path has less than n edges, so its cost stays exact
+	if (!isInteger || g->maxCost * g->n >= MAX_EXACT_INTEGER) {
+		g->costType = REAL_COSTS;
+	}
+	else {
+		g->costType = (g->maxCost <= INT_MAX) ? INT32_COSTS : INTEGER_COSTS;
 	}
-
-	fgets(line, sizeof(line), file); // Read END
-	
-	terms->n = n;
-	terms->vertices = terminals;
 }
 
 InducedSubGraph createInducedSubGraph(int *selectedVertices, int nSelectedVertices, bool *selectedEdges, Graph *g) {
-	int sumDegrees = 0;
 	bool *isInSub = calloc(g->n, sizeof(bool));
-	for (int v = 0; v < nSelectedVertices; v++) {
-		int selectedV = selectedVertices[v];
-		isInSub[selectedV] = true;
-		sumDegrees += g->vertices[selectedV].deg;
-	}
-
-	Graph *subG = createGraph(nSelectedVertices, sumDegrees);
-	int capOfOrigEdgeI = 100;
-	int *origEdgeI = calloc(100, sizeof(int));
-	
 	int *oldIDtoNewID = calloc(g->n, sizeof(int));
 	int *newIDtoOldID = calloc(nSelectedVertices, sizeof(int));
 	for (int v = 0; v < nSelectedVertices; v++) {
+		isInSub[selectedVertices[v]] = true;
 		oldIDtoNewID[selectedVertices[v]] = v;
 		newIDtoOldID[v] = selectedVertices[v];
 	}
 
-	// Copy vertices with their induced edges
+	// First pass: count induced edges (each edge is seen from both of its endpoints)
 	int nEdges = 0;
 	for (int newI = 0; newI < nSelectedVertices; newI++) {
 		int origV = selectedVertices[newI];
-		Vertex *vertex = &g->vertices[origV];
-
-		for (int i = 0; i < vertex->deg; i++) {
-			int globalEdgeI = vertex->edges[i];
+		for (int i = g->offsets[origV]; i < g->offsets[origV+1]; i++) {
+			int globalEdgeI = g->adjEdges[i];
 			if (selectedEdges != NULL && !selectedEdges[globalEdgeI]) {
 				continue; // Skip not desired edges
 			}
+			if (isInSub[g->adjVertices[i]] && origV != g->edges[globalEdgeI].v) {
+				nEdges++; // Count each edge only once
+			}
+		}
+	}
 
-			Edge *edge = getEdge(origV, i, g);
-			if (isInSub[edge->w]) {
-				// Edge belongs to induced subgraph
-				if (origV == edge->v) {
-					continue; // Add each edge only once
-				}
+	// Second pass: copy induced edges along with the mapping to their original index
+	Graph *subG = createGraph(nSelectedVertices, nEdges);
+	int *origEdgeI = calloc(nEdges, sizeof(int));
+	nEdges = 0;
+	for (int newI = 0; newI < nSelectedVertices; newI++) {
+		int origV = selectedVertices[newI];
+		for (int i = g->offsets[origV]; i < g->offsets[origV+1]; i++) {
+			int globalEdgeI = g->adjEdges[i];
+			if (selectedEdges != NULL && !selectedEdges[globalEdgeI]) {
+				continue;
+			}
+			Edge *edge = &g->edges[globalEdgeI];
+			if (isInSub[g->adjVertices[i]] && origV != edge->v) {
 				addEdge(oldIDtoNewID[edge->v], oldIDtoNewID[edge->w], edge->cost, nEdges, subG);
-
-				// Add mapping to original edge index
-				if (nEdges == capOfOrigEdgeI) {
-					capOfOrigEdgeI *= 2; // Increase capacity of mapping
-					origEdgeI = realloc(origEdgeI, sizeof(int) * capOfOrigEdgeI);
-				}
 				origEdgeI[nEdges] = globalEdgeI;
-
 				nEdges++;
 			}
 		}
 	}
+	buildAdjacency(subG);
 
 	free(oldIDtoNewID);
 	free(isInSub);
-	subG->m = nEdges;
 	return (InducedSubGraph){subG, newIDtoOldID, origEdgeI};
 }
 
 int sumOfDegrees(Graph *g) {
-	int sumDegs = 0;
-	for (int v = 0; v < g->n; v++) {
-		sumDegs += g->vertices[v].deg;
-	}
-	return sumDegs;
+	return g->offsets[g->n];
 }
 
 void freeInducedSubGraph(InducedSubGraph indSubG) {
@@ -215,7 +221,7 @@ void printEdge(Edge e) {
 }
 
 void printEdges(int v, Graph *g) {
-	for (int i = 0; i < g->vertices[v].deg; i++) {
+	for (int i = 0; i < getDegree(v, g); i++) {
 		printEdge(*getEdge(v, i, g));
 		printf(", ");
 	}
@@ -234,8 +240,8 @@ void printGraph(Graph *g) {
 	printf("- Vertices (to indices of arcs):\n");
 	for (int v = 0; v < g->n; v++) {
 		printf("v%d: ", v);
-		for (int e = 0; e < g->vertices[v].deg; e++) {
-			printf("%d, ", g->vertices[v].edges[e]);
+		for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+			printf("%d, ", g->adjEdges[i]);
 		}
 		printf("\n");
 	}
@@ -6,10 +6,12 @@
 
 typedef struct Edge Edge;
 
-typedef struct{
-	int n;
-	int m;
-} Sizes;
+// Cost type of a graph, selects the search kernels once the adjacency is built
+typedef enum {
+	REAL_COSTS,
+	INTEGER_COSTS, // Non-negative integers, every path cost is exact in a double
+	INT32_COSTS // Non-negative integers below 2^31, the adjacency holds them as int
+} CostType;
 
 typedef struct {
 	int *vertices;
@@ -22,17 +24,24 @@ struct Edge {
 	double cost;
 };
 
-typedef struct {
-	int *edges;
-	int capEdges;
-	int deg;
-} Vertex;
-
+// Adjacency is stored in compressed sparse row (CSR) format:
+// the incidences of v are at positions [offsets[v], offsets[v+1]) of the adj-arrays.
+// If mapping is set, all arrays point into that memory mapping instead of owning heap memory.
+// With INT32_COSTS, the costs of the adjacency are in adjIntCosts and adjCosts is NULL
+// (for mapped graphs, adjCosts stays in the mapping and adjIntCosts is owned heap memory).
 typedef struct {
 	int n;
 	int m;
-	Vertex *vertices;
 	Edge *edges;
+	int *offsets;
+	int *adjVertices;
+	int *adjEdges;
+	double *adjCosts;
+	void *mapping;
+	size_t mappingSize;
+	CostType costType;
+	double maxCost;
+	int *adjIntCosts;
 } Graph;
 
 typedef struct {
@@ -43,21 +52,27 @@ typedef struct {
 
 Graph *createGraph(int n, int m);
 
+Graph *createDoubledGraph(Graph *g);
+
 void freeGraph(Graph *g);
 
 void addEdge(int v, int w, double cost, int i, Graph *g);
 
-Edge *getEdge(int v, int edgeI, Graph *g);
+void buildAdjacency(Graph *g);
 
-int getEdgeIndex(int v, int edgeI, Graph *g);
+void classifyCosts(Graph *g);
 
-void scanTerminals(FILE *file, Terminals *terms);
+static inline double getAdjCost(int i, Graph *g) {
+	return g->adjIntCosts != NULL ? g->adjIntCosts[i] : g->adjCosts[i];
+}
 
-void freeTerminals(Terminals *terms);
+int getDegree(int v, Graph *g);
+
+Edge *getEdge(int v, int edgeI, Graph *g);
 
-Sizes scanGraphStructure(FILE *file, char *line, int lineSize);
+int getEdgeIndex(int v, int edgeI, Graph *g);
 
-Graph *scanGraph(FILE *file, Terminals *terms, bool doubleEdges);
+void freeTerminals(Terminals *terms);
 
 InducedSubGraph createInducedSubGraph(int *selectedVertices, int nSelectedVertices, bool *selectedEdges, Graph *g);
 
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "indexed-heap.h"
+
+#define ARITY 4
+
+IndexedHeap *createIndexedHeap(int n) {
+	IndexedHeap *h = calloc(1, sizeof(IndexedHeap));
+	Pair *heap = calloc(n, sizeof(Pair));
+	int *pos = calloc(n, sizeof(int));
+	for (int i = 0; i < n; i++) {
+		pos[i] = -1; // Not contained
+	}
+
+	*h = (IndexedHeap){n, 0, heap, pos};
+	return h;
+}
+
+void freeIndexedHeap(IndexedHeap *h) {
+	free(h->heap);
+	free(h->pos);
+	free(h);
+}
+
+bool isEmptyIndexedHeap(IndexedHeap *h) {
+	return h->size == 0;
+}
+
+bool containsKey(int key, IndexedHeap *h) {
+	return h->pos[key] != -1;
+}
+
+static void place(int i, Pair p, IndexedHeap *h) {
+	h->heap[i] = p;
+	h->pos[p.key] = i;
+}
+
+static void siftUp(int i, Pair p, IndexedHeap *h) {
+	while (i > 0) {
+		int parent = (i-1) / ARITY;
+		if (h->heap[parent].value <= p.value) {
+			break;
+		}
+		place(i, h->heap[parent], h); // Move parent down, p takes its place later
+		i = parent;
+	}
+	place(i, p, h);
+}
+
+static void siftDown(int i, Pair p, IndexedHeap *h) {
+	while (true) {
+		int firstChild = ARITY*i + 1;
+		if (firstChild >= h->size) {
+			break;
+		}
+		int lastChild = firstChild + ARITY;
+		if (lastChild > h->size) {
+			lastChild = h->size;
+		}
+
+		// Select smallest child
+		int minChild = firstChild;
+		for (int c = firstChild+1; c < lastChild; c++) {
+			if (h->heap[c].value < h->heap[minChild].value) {
+				minChild = c;
+			}
+		}
+		if (p.value <= h->heap[minChild].value) {
+			break;
+		}
+		place(i, h->heap[minChild], h);
+		i = minChild;
+	}
+	place(i, p, h);
+}
+
+void insertIndexedHeap(Pair p, IndexedHeap *h) {
+	if (h->size == h->n) {
+		fprintf(stderr, "Overflow in IndexedHeap.\n");
+		exit(EXIT_FAILURE);
+	}
+	h->size++;
+	siftUp(h->size-1, p, h);
+}
+
+void decreaseKey(int key, double newValue, IndexedHeap *h) {
+	int i = h->pos[key];
+	if (newValue >= h->heap[i].value) {
+		return; // Not a decrease
+	}
+	siftUp(i, (Pair){key, newValue}, h);
+}
+
+Pair extractMinIndexedHeap(IndexedHeap *h) {
+	if (h->size == 0) {
+		fprintf(stderr, "Underflow in IndexedHeap.\n");
+		exit(EXIT_FAILURE);
+	}
+	Pair min = h->heap[0];
+	h->pos[min.key] = -1;
+	h->size--;
+
+	if (h->size > 0) {
+		siftDown(0, h->heap[h->size], h); // Last leaf replaces the root
+	}
+	return min;
+}
+
+void clearIndexedHeap(IndexedHeap *h) {
+	for (int i = 0; i < h->size; i++) {
+		h->pos[h->heap[i].key] = -1;
+	}
+	h->size = 0;
+}
@@ -0,0 +1,33 @@
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <stdbool.h>
+
+#include "prio-queue.h"
+
+// 4-ary min-heap over the keys 0..n-1 with position tracking,
+// so each key is contained at most once and supports decreaseKey.
+typedef struct {
+	int n;
+	int size;
+	Pair *heap;
+	int *pos;
+} IndexedHeap;
+
+IndexedHeap *createIndexedHeap(int n);
+
+void freeIndexedHeap(IndexedHeap *h);
+
+bool isEmptyIndexedHeap(IndexedHeap *h);
+
+bool containsKey(int key, IndexedHeap *h);
+
+void insertIndexedHeap(Pair p, IndexedHeap *h);
+
+void decreaseKey(int key, double newValue, IndexedHeap *h);
+
+Pair extractMinIndexedHeap(IndexedHeap *h);
+
+void clearIndexedHeap(IndexedHeap *h);
+
+#endif
@@ -16,6 +16,10 @@ void freePrioQueue(PrioQueue *pq) {
 	free(pq);
 }
 
+void clearPrioQueue(PrioQueue *pq) {
+	pq->indexLastLeaf = -1;
+}
+
 bool isEmpty(PrioQueue *pq) {
 	return pq->indexLastLeaf == -1;
 }
@@ -20,6 +20,8 @@ PrioQueue *createPrioQueue(int n);
 
 void freePrioQueue(PrioQueue *pq);
 
+void clearPrioQueue(PrioQueue *pq);
+
 bool isEmpty(PrioQueue *pq);
 
 void insert(Pair p, PrioQueue *pq);
@@ -29,6 +31,6 @@ void insert(Pair p, PrioQueue *pq);
 
 Pair extractMin(PrioQueue *pq);
 
-void printQueue(PrioQueue *pq);
+void printPrioQueue(PrioQueue *pq);
 
 #endif
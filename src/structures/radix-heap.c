@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "radix-heap.h"
+
+RadixHeap *createRadixHeap(int n) {
+	RadixHeap *h = calloc(1, sizeof(RadixHeap));
+	h->n = n;
+	h->values = calloc(n, sizeof(unsigned long long));
+	h->bucketOf = calloc(n, sizeof(int));
+	h->next = calloc(n, sizeof(int));
+	h->prev = calloc(n, sizeof(int));
+	for (int i = 0; i < n; i++) {
+		h->bucketOf[i] = -1; // Not contained
+	}
+	for (int b = 0; b < RADIX_BUCKETS; b++) {
+		h->heads[b] = -1;
+	}
+	return h;
+}
+
+void freeRadixHeap(RadixHeap *h) {
+	free(h->values);
+	free(h->bucketOf);
+	free(h->next);
+	free(h->prev);
+	free(h);
+}
+
+bool isEmptyRadixHeap(RadixHeap *h) {
+	return h->size == 0;
+}
+
+static int bucketIndex(unsigned long long value, unsigned long long last) {
+	if (value == last) {
+		return 0;
+	}
+	return 64 - __builtin_clzll(value ^ last);
+}
+
+static void linkKey(int key, int b, RadixHeap *h) {
+	h->bucketOf[key] = b;
+	h->prev[key] = -1;
+	h->next[key] = h->heads[b];
+	if (h->heads[b] != -1) {
+		h->prev[h->heads[b]] = key;
+	}
+	h->heads[b] = key;
+}
+
+static void unlinkKey(int key, RadixHeap *h) {
+	int b = h->bucketOf[key];
+	if (h->prev[key] != -1) {
+		h->next[h->prev[key]] = h->next[key];
+	}
+	else {
+		h->heads[b] = h->next[key];
+	}
+	if (h->next[key] != -1) {
+		h->prev[h->next[key]] = h->prev[key];
+	}
+	h->bucketOf[key] = -1;
+}
+
+// Moves all keys of bucket b to the buckets of their values relative to the current last
+static void redistribute(int b, RadixHeap *h) {
+	int key = h->heads[b];
+	h->heads[b] = -1;
+	while (key != -1) {
+		int next = h->next[key];
+		linkKey(key, bucketIndex(h->values[key], h->last), h);
+		key = next;
+	}
+}
+
+void pushRadixHeap(int key, unsigned long long v, RadixHeap *h) {
+	if (h->bucketOf[key] != -1) {
+		if (v >= h->values[key]) {
+			return; // Not a decrease
+		}
+		unlinkKey(key, h);
+		h->size--;
+	}
+	if (h->size == 0) {
+		h->last = v;
+	}
+	else if (v < h->last) {
+		// Not monotone: all contained values are larger than v, so every bucket is rebuilt around v
+		h->last = v;
+		for (int b = 0; b < RADIX_BUCKETS; b++) {
+			redistribute(b, h);
+		}
+	}
+	h->values[key] = v;
+	linkKey(key, bucketIndex(v, h->last), h);
+	h->size++;
+}
+
+int extractMinRadixHeap(RadixHeap *h, unsigned long long *value) {
+	if (h->size == 0) {
+		fprintf(stderr, "Underflow in RadixHeap.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (h->heads[0] == -1) {
+		// The minimum of the first non-empty bucket becomes last, its bucket splits into lower ones
+		int b = 1;
+		while (h->heads[b] == -1) {
+			b++;
+		}
+		unsigned long long min = h->values[h->heads[b]];
+		for (int key = h->heads[b]; key != -1; key = h->next[key]) {
+			if (h->values[key] < min) {
+				min = h->values[key];
+			}
+		}
+		h->last = min;
+		redistribute(b, h);
+	}
+	int key = h->heads[0];
+	unlinkKey(key, h);
+	h->size--;
+	*value = h->values[key];
+	return key;
+}
+
+void clearRadixHeap(RadixHeap *h) {
+	if (h->size == 0) {
+		return; // All lists are empty already
+	}
+	for (int b = 0; b < RADIX_BUCKETS; b++) {
+		for (int key = h->heads[b]; key != -1; key = h->next[key]) {
+			h->bucketOf[key] = -1;
+		}
+		h->heads[b] = -1;
+	}
+	h->size = 0;
+}
@@ -0,0 +1,37 @@
+#ifndef RADIXHEAP_H
+#define RADIXHEAP_H
+
+#include <stdbool.h>
+
+#define RADIX_BUCKETS 65 // Bucket 0 holds values equal to last, bucket b values that first differ from last in bit b-1
+
+// Monotone radix heap over the keys 0..n-1 for non-negative integer values.
+// Each key is contained at most once, the buckets are linked lists through next and prev.
+// A value below the last extracted minimum rebuilds the heap around it (O(size)), so searches can still be
+// extended by new sources into an empty heap. Searches whose pushes are not monotone otherwise use the heap.
+typedef struct {
+	int n;
+	int size;
+	unsigned long long last;
+	unsigned long long *values;
+	int *bucketOf; // -1 if not contained
+	int *next;
+	int *prev;
+	int heads[RADIX_BUCKETS];
+} RadixHeap;
+
+RadixHeap *createRadixHeap(int n);
+
+void freeRadixHeap(RadixHeap *h);
+
+bool isEmptyRadixHeap(RadixHeap *h);
+
+// Inserts key or lowers its value (a higher value is ignored)
+void pushRadixHeap(int key, unsigned long long value, RadixHeap *h);
+
+// Removes a key of minimum value and returns it, value receives its value
+int extractMinRadixHeap(RadixHeap *h, unsigned long long *value);
+
+void clearRadixHeap(RadixHeap *h);
+
+#endif
@@ -0,0 +1,69 @@
+#include <stdlib.h>
+
+#include "search-queue.h"
+
+SearchQueue *createSearchQueue(int n) {
+	SearchQueue *q = calloc(1, sizeof(SearchQueue));
+	q->n = n;
+	q->kind = HEAP_QUEUE;
+	return q;
+}
+
+void freeSearchQueue(SearchQueue *q) {
+	if (q->heap != NULL) {
+#ifdef LAZY_PRIO_QUEUE
+		freePrioQueue(q->heap);
+#else
+		freeIndexedHeap(q->heap);
+#endif
+	}
+	if (q->radix != NULL) {
+		freeRadixHeap(q->radix);
+	}
+	if (q->buckets != NULL) {
+		freeBucketQueue(q->buckets);
+	}
+	free(q);
+}
+
+static QueueKind selectQueueKind(Graph *g, bool monotone) {
+	if (g->costType == REAL_COSTS) {
+		return HEAP_QUEUE;
+	}
+	if (g->maxCost <= MAX_DIAL_COST) {
+		return BUCKET_QUEUE;
+	}
+	// Prim would rebuild the radix heap on almost every push
+	return monotone ? RADIX_QUEUE : HEAP_QUEUE;
+}
+
+void prepareSearchQueue(SearchQueue *q, Graph *g, bool monotone) {
+	QueueKind kind = selectQueueKind(g, monotone);
+	bool isCreated = q->kind != HEAP_QUEUE || q->heap != NULL;
+	if (kind != q->kind && isCreated) {
+		clearSearchQueue(q); // Entries of a search on another graph are dropped
+	}
+	q->kind = kind;
+
+	if (kind == HEAP_QUEUE && q->heap == NULL) {
+#ifdef LAZY_PRIO_QUEUE
+		q->heap = createPrioQueue(q->n);
+#else
+		q->heap = createIndexedHeap(q->n);
+#endif
+	}
+	else if (kind == RADIX_QUEUE && q->radix == NULL) {
+		q->radix = createRadixHeap(q->n);
+	}
+	else if (kind == BUCKET_QUEUE) {
+		// The window has to cover the largest cost, a larger one from a previous graph is fine
+		int nBuckets = (int)g->maxCost + 1;
+		if (q->buckets != NULL && q->buckets->nBuckets < nBuckets) {
+			freeBucketQueue(q->buckets);
+			q->buckets = NULL;
+		}
+		if (q->buckets == NULL) {
+			q->buckets = createBucketQueue(q->n, nBuckets);
+		}
+	}
+}
@@ -0,0 +1,119 @@
+#ifndef SEARCHQUEUE_H
+#define SEARCHQUEUE_H
+
+// Priority queue used by Dijkstra and Prim, selected for the costs of the searched graph:
+// - integer costs up to MAX_DIAL_COST: Dial's bucket queue with one bucket per cost value
+// - larger integer costs: radix heap for Dijkstra, Prim keeps the comparison heap
+// - other costs: comparison heap, selected at compile time:
+//   - default: indexed 4-ary heap with decreaseKey and a fixed capacity of n
+//   - LAZY_PRIO_QUEUE: binary heap with lazy deletion, which inserts a new entry on every decrease
+// Bucket queue and radix heap take and return the integer values directly, the heap holds (key, double) pairs.
+// With all queues, the searches skip extracted entries whose value is outdated.
+// The searches are instantiated per queue and call its operations directly, see dijkstra-kernel.h.
+
+#include <stdbool.h>
+
+#include "graph.h"
+#include "prio-queue.h"
+#include "indexed-heap.h"
+#include "radix-heap.h"
+#include "bucket-queue.h"
+
+#define MAX_DIAL_COST 4096
+
+typedef enum { HEAP_QUEUE, RADIX_QUEUE, BUCKET_QUEUE } QueueKind;
+
+#ifdef LAZY_PRIO_QUEUE
+typedef PrioQueue HeapQueue;
+#else
+typedef IndexedHeap HeapQueue;
+#endif
+
+// Queues are created on first use, a queue only holds the one that fits the last searched graph
+typedef struct {
+	int n;
+	QueueKind kind;
+	HeapQueue *heap;
+	RadixHeap *radix;
+	BucketQueue *buckets;
+} SearchQueue;
+
+SearchQueue *createSearchQueue(int n);
+
+void freeSearchQueue(SearchQueue *q);
+
+// Selects the queue for the costs of g. Without monotone, extracted values may decrease (Prim).
+void prepareSearchQueue(SearchQueue *q, Graph *g, bool monotone);
+
+#ifdef LAZY_PRIO_QUEUE
+
+static inline void pushHeapQueue(int key, double value, HeapQueue *h) {
+	insert((Pair){key, value}, h);
+}
+
+static inline int popHeapQueue(HeapQueue *h, double *value) {
+	Pair p = extractMin(h);
+	*value = p.value;
+	return p.key;
+}
+
+static inline bool isEmptyHeapQueue(HeapQueue *h) {
+	return isEmpty(h);
+}
+
+static inline void clearHeapQueue(HeapQueue *h) {
+	clearPrioQueue(h);
+}
+
+#else
+
+static inline void pushHeapQueue(int key, double value, HeapQueue *h) {
+	if (containsKey(key, h)) {
+		decreaseKey(key, value, h);
+	}
+	else {
+		insertIndexedHeap((Pair){key, value}, h);
+	}
+}
+
+static inline int popHeapQueue(HeapQueue *h, double *value) {
+	Pair p = extractMinIndexedHeap(h);
+	*value = p.value;
+	return p.key;
+}
+
+static inline bool isEmptyHeapQueue(HeapQueue *h) {
+	return isEmptyIndexedHeap(h);
+}
+
+static inline void clearHeapQueue(HeapQueue *h) {
+	clearIndexedHeap(h);
+}
+
+#endif
+
+static inline bool isEmptySearchQueue(SearchQueue *q) {
+	switch (q->kind) {
+		case BUCKET_QUEUE:
+			return isEmptyBucketQueue(q->buckets);
+		case RADIX_QUEUE:
+			return isEmptyRadixHeap(q->radix);
+		default:
+			return isEmptyHeapQueue(q->heap);
+	}
+}
+
+static inline void clearSearchQueue(SearchQueue *q) {
+	switch (q->kind) {
+		case BUCKET_QUEUE:
+			clearBucketQueue(q->buckets);
+			break;
+		case RADIX_QUEUE:
+			clearRadixHeap(q->radix);
+			break;
+		default:
+			clearHeapQueue(q->heap);
+	}
+}
+
+#endif
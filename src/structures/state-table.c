@@ -0,0 +1,79 @@
+#include <stdlib.h>
+
+#include "state-table.h"
+
+static void resetSlots(int nSlots, StateTable *t) {
+	free(t->slots);
+	t->nSlots = nSlots;
+	t->slots = calloc(nSlots, sizeof(int));
+	for (int i = 0; i < nSlots; i++) {
+		t->slots[i] = -1;
+	}
+}
+
+StateTable *createStateTable(int cap) {
+	StateTable *t = calloc(1, sizeof(StateTable));
+	t->cap = (cap < 16) ? 16 : cap;
+	t->entries = calloc(t->cap, sizeof(StateEntry));
+	int nSlots = 32;
+	while (nSlots < 2 * t->cap) {
+		nSlots *= 2;
+	}
+	resetSlots(nSlots, t);
+	return t;
+}
+
+void freeStateTable(StateTable *t) {
+	free(t->entries);
+	free(t->slots);
+	free(t);
+}
+
+void freeStateSlots(StateTable *t) {
+	t->cap = (t->n > 0) ? t->n : 1;
+	t->entries = realloc(t->entries, t->cap * sizeof(StateEntry));
+	free(t->slots);
+	t->slots = NULL;
+	t->nSlots = 0;
+}
+
+static int findSlot(uint64_t key, StateTable *t) {
+	// Fibonacci hashing, the upper bits are the best mixed
+	uint64_t hash = key * 0x9E3779B97F4A7C15ULL;
+	int mask = t->nSlots - 1;
+	int i = (int)(hash >> 32) & mask;
+	while (t->slots[i] != -1 && t->entries[t->slots[i]].key != key) {
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+// Keeps the load factor of the slots at most 1/2
+static void grow(StateTable *t) {
+	t->cap *= 2;
+	t->entries = realloc(t->entries, t->cap * sizeof(StateEntry));
+	resetSlots(2 * t->nSlots, t);
+	for (int j = 0; j < t->n; j++) {
+		t->slots[findSlot(t->entries[j].key, t)] = j;
+	}
+}
+
+void offerState(uint64_t key, double cost, int from0, int from1, StateTable *t) {
+	int i = findSlot(key, t);
+	if (t->slots[i] != -1) {
+		StateEntry *e = &t->entries[t->slots[i]];
+		if (cost < e->cost) {
+			e->cost = cost;
+			e->from[0] = from0;
+			e->from[1] = from1;
+		}
+		return;
+	}
+	if (t->n == t->cap) {
+		grow(t);
+		i = findSlot(key, t);
+	}
+	t->slots[i] = t->n;
+	t->entries[t->n] = (StateEntry){key, cost, {from0, from1}};
+	t->n++;
+}
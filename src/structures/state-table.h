@@ -0,0 +1,33 @@
+#ifndef STATE_TABLE_H
+#define STATE_TABLE_H
+
+#include <stdint.h>
+
+// Cheapest partial solution of a state, from holds the entries of the child tables it was built from
+typedef struct {
+	uint64_t key;
+	double cost;
+	int from[2];
+} StateEntry;
+
+// Hash table with open addressing from state keys to the cheapest entry.
+// Entries stay in insertion order, the slots can be dropped once the table is complete.
+typedef struct {
+	int n;
+	int cap;
+	StateEntry *entries;
+	int nSlots; // Power of two
+	int *slots; // Entry index or -1
+} StateTable;
+
+StateTable *createStateTable(int cap);
+
+void freeStateTable(StateTable *t);
+
+// Adds the state or lowers its cost
+void offerState(uint64_t key, double cost, int from0, int from1, StateTable *t);
+
+// Frees the slots and unused entries, the table stays readable
+void freeStateSlots(StateTable *t);
+
+#endif
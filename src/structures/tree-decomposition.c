@@ -0,0 +1,424 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "tree-decomposition.h"
+#include "prio-queue.h"
+#include "union-find.h"
+
+TreeDecomposition *createTreeDecomposition(int nBags, int nBagVertices, int nTreeEdges) {
+	TreeDecomposition *td = calloc(1, sizeof(TreeDecomposition));
+	td->nBags = nBags;
+	td->bagStarts = calloc(nBags + 1, sizeof(int));
+	td->bagVertices = calloc(nBagVertices + 1, sizeof(int));
+	td->nTreeEdges = nTreeEdges;
+	td->treeEdges = calloc(2 * nTreeEdges + 1, sizeof(int));
+	return td;
+}
+
+void freeTreeDecomposition(TreeDecomposition *td) {
+	free(td->bagStarts);
+	free(td->bagVertices);
+	free(td->treeEdges);
+	free(td);
+}
+
+// Neighbor lists of the elimination game, which contain eliminated vertices and duplicates until they are compacted
+typedef struct {
+	int **lists;
+	int *sizes;
+	int *caps;
+	int *stamps;
+	int stamp;
+} EliminationGraph;
+
+static void appendNeighbor(int v, int u, EliminationGraph *eg) {
+	if (eg->sizes[v] == eg->caps[v]) {
+		eg->caps[v] = 2 * eg->caps[v] + 4;
+		eg->lists[v] = realloc(eg->lists[v], eg->caps[v] * sizeof(int));
+	}
+	eg->lists[v][eg->sizes[v]] = u;
+	eg->sizes[v]++;
+}
+
+static void compactNeighbors(int v, bool *isEliminated, EliminationGraph *eg) {
+	eg->stamp++;
+	int size = 0;
+	for (int i = 0; i < eg->sizes[v]; i++) {
+		int u = eg->lists[v][i];
+		if (u != v && !isEliminated[u] && eg->stamps[u] != eg->stamp) {
+			eg->stamps[u] = eg->stamp;
+			eg->lists[v][size] = u;
+			size++;
+		}
+	}
+	eg->sizes[v] = size;
+}
+
+static void freeEliminationGraph(EliminationGraph *eg, int n) {
+	for (int v = 0; v < n; v++) {
+		free(eg->lists[v]);
+	}
+	free(eg->lists);
+	free(eg->sizes);
+	free(eg->caps);
+	free(eg->stamps);
+}
+
+TreeDecomposition *minDegreeDecomposition(Graph *g, int maxWidth) {
+	EliminationGraph eg;
+	eg.lists = calloc(g->n, sizeof(int*));
+	eg.sizes = calloc(g->n, sizeof(int));
+	eg.caps = calloc(g->n, sizeof(int));
+	eg.stamps = calloc(g->n, sizeof(int));
+	eg.stamp = 0;
+	bool *isEliminated = calloc(g->n, sizeof(bool));
+	int *estDegrees = calloc(g->n, sizeof(int)); // Upper bounds, exact once the list is compacted
+	PrioQueue *pq = createPrioQueue(g->n + 1);
+	for (int v = 0; v < g->n; v++) {
+		for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+			appendNeighbor(v, g->adjVertices[i], &eg);
+		}
+		compactNeighbors(v, isEliminated, &eg);
+		estDegrees[v] = eg.sizes[v];
+		insert((Pair){v, estDegrees[v]}, pq);
+	}
+
+	// Bag i is the vertex eliminated as i-th with its neighbors at that time
+	int *bagStarts = calloc(g->n + 1, sizeof(int));
+	int *bagVertices = calloc((size_t)g->n * (maxWidth + 1) + 1, sizeof(int));
+	int *positions = calloc(g->n, sizeof(int));
+	int nBags = 0;
+	int nBagVertices = 0;
+	int width = 0;
+	bool failed = false;
+	while (!isEmpty(pq)) {
+		Pair p = extractMin(pq);
+		int v = p.key;
+		if (isEliminated[v] || p.value != estDegrees[v]) {
+			continue; // Old entry
+		}
+		compactNeighbors(v, isEliminated, &eg);
+		int degree = eg.sizes[v];
+		if (degree != estDegrees[v]) {
+			estDegrees[v] = degree;
+			insert((Pair){v, degree}, pq);
+			continue;
+		}
+		if (degree > maxWidth) {
+			failed = true;
+			break;
+		}
+		if (degree > width) {
+			width = degree;
+		}
+
+		isEliminated[v] = true;
+		positions[v] = nBags;
+		bagVertices[nBagVertices++] = v;
+		int *neighbors = eg.lists[v];
+		for (int i = 0; i < degree; i++) {
+			int u = neighbors[i];
+			bagVertices[nBagVertices++] = u;
+			// The neighbors become a clique
+			for (int j = 0; j < degree; j++) {
+				if (j != i) {
+					appendNeighbor(u, neighbors[j], &eg);
+				}
+			}
+			estDegrees[u] += degree - 2;
+			insert((Pair){u, estDegrees[u]}, pq);
+		}
+		nBags++;
+		bagStarts[nBags] = nBagVertices;
+	}
+	freePrioQueue(pq);
+	freeEliminationGraph(&eg, g->n);
+	free(isEliminated);
+	free(estDegrees);
+	if (failed) {
+		free(bagStarts);
+		free(bagVertices);
+		free(positions);
+		return NULL;
+	}
+
+	// The parent of a bag is the one of its neighbor that is eliminated next
+	TreeDecomposition *td = createTreeDecomposition(nBags, nBagVertices, nBags);
+	td->width = width;
+	for (int i = 0; i <= nBags; i++) {
+		td->bagStarts[i] = bagStarts[i];
+	}
+	for (int i = 0; i < nBagVertices; i++) {
+		td->bagVertices[i] = bagVertices[i];
+	}
+	td->nTreeEdges = 0;
+	for (int i = 0; i < nBags; i++) {
+		int parent = -1;
+		for (int j = bagStarts[i] + 1; j < bagStarts[i+1]; j++) {
+			int pos = positions[bagVertices[j]];
+			if (parent == -1 || pos < parent) {
+				parent = pos;
+			}
+		}
+		if (parent != -1) {
+			td->treeEdges[2 * td->nTreeEdges] = i;
+			td->treeEdges[2 * td->nTreeEdges + 1] = parent;
+			td->nTreeEdges++;
+		}
+	}
+	free(bagStarts);
+	free(bagVertices);
+	free(positions);
+	return td;
+}
+
+// Checks that the tree edges form a forest, no bag repeats a vertex and the bags of every vertex are connected.
+// The root vertex is exempt, it is added to all bags.
+static bool isValidDecomposition(TreeDecomposition *td, int rootVertex, int n) {
+	UnionFind *uf = createUnionFind(td->nBags);
+	bool isValid = true;
+	for (int i = 0; i < td->nTreeEdges && isValid; i++) {
+		int a = td->treeEdges[2*i];
+		int b = td->treeEdges[2*i + 1];
+		if (findSet(uf, a) == findSet(uf, b)) {
+			isValid = false;
+		}
+		unionSet(uf, a, b);
+	}
+	freeUnionFind(uf);
+
+	// The bags of a vertex induce a forest, which is connected iff it has one edge less than bags
+	int *nBagsOf = calloc(n, sizeof(int));
+	int *nSharedEdges = calloc(n, sizeof(int));
+	int *stamps = calloc(n, sizeof(int));
+	for (int b = 0; b < td->nBags && isValid; b++) {
+		for (int j = td->bagStarts[b]; j < td->bagStarts[b+1]; j++) {
+			int v = td->bagVertices[j];
+			if (stamps[v] == b+1) {
+				isValid = false;
+			}
+			stamps[v] = b+1;
+			nBagsOf[v]++;
+		}
+	}
+	for (int i = 0; i < td->nTreeEdges && isValid; i++) {
+		int a = td->treeEdges[2*i];
+		int b = td->treeEdges[2*i + 1];
+		for (int j = td->bagStarts[a]; j < td->bagStarts[a+1]; j++) {
+			stamps[td->bagVertices[j]] = -(i+1);
+		}
+		for (int j = td->bagStarts[b]; j < td->bagStarts[b+1]; j++) {
+			if (stamps[td->bagVertices[j]] == -(i+1)) {
+				nSharedEdges[td->bagVertices[j]]++;
+			}
+		}
+	}
+	for (int v = 0; v < n && isValid; v++) {
+		if (v != rootVertex && nBagsOf[v] > 0 && nSharedEdges[v] != nBagsOf[v] - 1) {
+			isValid = false;
+		}
+	}
+	free(nBagsOf);
+	free(nSharedEdges);
+	free(stamps);
+	return isValid;
+}
+
+static int addNiceNode(NiceNodeType type, int item, int child0, int child1, NiceTreeDecomposition *ntd) {
+	if (ntd->nNodes == ntd->cap) {
+		ntd->cap *= 2;
+		ntd->types = realloc(ntd->types, ntd->cap * sizeof(NiceNodeType));
+		ntd->items = realloc(ntd->items, ntd->cap * sizeof(int));
+		ntd->children = realloc(ntd->children, 2 * ntd->cap * sizeof(int));
+	}
+	int i = ntd->nNodes;
+	ntd->types[i] = type;
+	ntd->items[i] = item;
+	ntd->children[2*i] = child0;
+	ntd->children[2*i + 1] = child1;
+	ntd->nNodes++;
+	return i;
+}
+
+// Introduces the edges between v and the current bag that are not introduced yet, then forgets v
+static int forgetVertex(int v, int node, bool *inBag, bool *isIntroduced, Graph *g, NiceTreeDecomposition *ntd) {
+	for (int i = g->offsets[v]; i < g->offsets[v+1]; i++) {
+		int e = g->adjEdges[i];
+		int u = g->adjVertices[i];
+		if (u != v && inBag[u] && !isIntroduced[e]) {
+			isIntroduced[e] = true;
+			node = addNiceNode(NICE_INTRODUCE_EDGE, e, node, -1, ntd);
+		}
+	}
+	inBag[v] = false;
+	return addNiceNode(NICE_FORGET, v, node, -1, ntd);
+}
+
+static void markBag(int b, bool value, TreeDecomposition *td, bool *inBag) {
+	for (int j = td->bagStarts[b]; j < td->bagStarts[b+1]; j++) {
+		inBag[td->bagVertices[j]] = value;
+	}
+}
+
+static bool bagContains(int b, int v, TreeDecomposition *td) {
+	for (int j = td->bagStarts[b]; j < td->bagStarts[b+1]; j++) {
+		if (td->bagVertices[j] == v) {
+			return true;
+		}
+	}
+	return false;
+}
+
+NiceTreeDecomposition *createNiceTreeDecomposition(TreeDecomposition *td, int rootVertex, Graph *g) {
+	if (!isValidDecomposition(td, rootVertex, g->n)) {
+		return NULL;
+	}
+
+	// Tree adjacency of the bags
+	int *treeOffsets = calloc(td->nBags + 1, sizeof(int));
+	int *treeAdj = calloc(2 * td->nTreeEdges + 1, sizeof(int));
+	for (int i = 0; i < 2 * td->nTreeEdges; i++) {
+		treeOffsets[td->treeEdges[i] + 1]++;
+	}
+	for (int b = 0; b < td->nBags; b++) {
+		treeOffsets[b+1] += treeOffsets[b];
+	}
+	int *fill = calloc(td->nBags + 1, sizeof(int));
+	for (int i = 0; i < td->nTreeEdges; i++) {
+		int a = td->treeEdges[2*i];
+		int b = td->treeEdges[2*i + 1];
+		treeAdj[treeOffsets[a] + fill[a]++] = b;
+		treeAdj[treeOffsets[b] + fill[b]++] = a;
+	}
+	free(fill);
+
+	// BFS order from a root bag per component, parents come before their children
+	int *order = calloc(td->nBags + 1, sizeof(int));
+	int *parents = calloc(td->nBags + 1, sizeof(int));
+	bool *isVisited = calloc(td->nBags + 1, sizeof(bool));
+	int nOrdered = 0;
+	for (int root = 0; root < td->nBags; root++) {
+		if (isVisited[root]) {
+			continue;
+		}
+		isVisited[root] = true;
+		parents[root] = -1;
+		order[nOrdered++] = root;
+		for (int q = nOrdered - 1; q < nOrdered; q++) {
+			int b = order[q];
+			for (int k = treeOffsets[b]; k < treeOffsets[b+1]; k++) {
+				if (!isVisited[treeAdj[k]]) {
+					isVisited[treeAdj[k]] = true;
+					parents[treeAdj[k]] = b;
+					order[nOrdered++] = treeAdj[k];
+				}
+			}
+		}
+	}
+	free(isVisited);
+
+	NiceTreeDecomposition *ntd = calloc(1, sizeof(NiceTreeDecomposition));
+	ntd->cap = 2 * td->bagStarts[td->nBags] + 2 * td->nBags + g->m + 16;
+	ntd->types = calloc(ntd->cap, sizeof(NiceNodeType));
+	ntd->items = calloc(ntd->cap, sizeof(int));
+	ntd->children = calloc(2 * ntd->cap, sizeof(int));
+	ntd->rootVertex = rootVertex;
+	ntd->width = 0;
+
+	bool *inBag = calloc(g->n, sizeof(bool));
+	bool *isIntroduced = calloc(g->m + 1, sizeof(bool));
+	int *tops = calloc(td->nBags + 1, sizeof(int)); // Node whose bag is the bag with the root vertex
+	inBag[rootVertex] = true;
+	for (int q = nOrdered - 1; q >= 0; q--) {
+		int b = order[q];
+		int bagSize = td->bagStarts[b+1] - td->bagStarts[b];
+		int width = bagContains(b, rootVertex, td) ? bagSize - 1 : bagSize;
+		if (width > ntd->width) {
+			ntd->width = width;
+		}
+
+		int node = -1;
+		for (int k = treeOffsets[b]; k < treeOffsets[b+1]; k++) {
+			int c = treeAdj[k];
+			if (c == parents[b]) {
+				continue;
+			}
+			// Forget the vertices of the child that are not in b, then introduce the missing ones of b
+			markBag(c, true, td, inBag);
+			int branch = tops[c];
+			for (int j = td->bagStarts[c]; j < td->bagStarts[c+1]; j++) {
+				int v = td->bagVertices[j];
+				if (v != rootVertex && !bagContains(b, v, td)) {
+					branch = forgetVertex(v, branch, inBag, isIntroduced, g, ntd);
+				}
+			}
+			for (int j = td->bagStarts[b]; j < td->bagStarts[b+1]; j++) {
+				int v = td->bagVertices[j];
+				if (!inBag[v]) {
+					inBag[v] = true;
+					branch = addNiceNode(NICE_INTRODUCE, v, branch, -1, ntd);
+				}
+			}
+			markBag(b, false, td, inBag);
+			inBag[rootVertex] = true;
+			node = (node == -1) ? branch : addNiceNode(NICE_JOIN, -1, node, branch, ntd);
+		}
+		if (node == -1) {
+			node = addNiceNode(NICE_LEAF, -1, -1, -1, ntd);
+			for (int j = td->bagStarts[b]; j < td->bagStarts[b+1]; j++) {
+				if (td->bagVertices[j] != rootVertex) {
+					node = addNiceNode(NICE_INTRODUCE, td->bagVertices[j], node, -1, ntd);
+				}
+			}
+		}
+		tops[b] = node;
+	}
+
+	// Root bags of all components are reduced to the root vertex and joined
+	int root = -1;
+	for (int q = 0; q < nOrdered; q++) {
+		int b = order[q];
+		if (parents[b] != -1) {
+			continue;
+		}
+		markBag(b, true, td, inBag);
+		inBag[rootVertex] = true;
+		int branch = tops[b];
+		for (int j = td->bagStarts[b]; j < td->bagStarts[b+1]; j++) {
+			if (td->bagVertices[j] != rootVertex) {
+				branch = forgetVertex(td->bagVertices[j], branch, inBag, isIntroduced, g, ntd);
+			}
+		}
+		root = (root == -1) ? branch : addNiceNode(NICE_JOIN, -1, root, branch, ntd);
+	}
+	if (root == -1) {
+		addNiceNode(NICE_LEAF, -1, -1, -1, ntd);
+	}
+
+	bool isCovered = true;
+	for (int i = 0; i < g->m; i++) {
+		if (g->edges[i].v != g->edges[i].w && !isIntroduced[i]) {
+			isCovered = false; // Edge is in no bag
+		}
+	}
+	free(treeOffsets);
+	free(treeAdj);
+	free(order);
+	free(parents);
+	free(inBag);
+	free(isIntroduced);
+	free(tops);
+	if (!isCovered) {
+		freeNiceTreeDecomposition(ntd);
+		return NULL;
+	}
+	return ntd;
+}
+
+void freeNiceTreeDecomposition(NiceTreeDecomposition *ntd) {
+	free(ntd->types);
+	free(ntd->items);
+	free(ntd->children);
+	free(ntd);
+}
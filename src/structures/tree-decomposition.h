@@ -0,0 +1,44 @@
+#ifndef TREE_DECOMPOSITION_H
+#define TREE_DECOMPOSITION_H
+
+#include "graph.h"
+
+// Bag i holds the vertices at positions [bagStarts[i], bagStarts[i+1]) of bagVertices.
+// The tree edges are pairs of bags, they may form a forest.
+typedef struct {
+	int nBags;
+	int width; // Size of the largest bag - 1
+	int *bagStarts;
+	int *bagVertices;
+	int nTreeEdges;
+	int *treeEdges;
+} TreeDecomposition;
+
+typedef enum { NICE_LEAF, NICE_INTRODUCE, NICE_INTRODUCE_EDGE, NICE_FORGET, NICE_JOIN } NiceNodeType;
+
+// Nice tree decomposition with the root vertex in every bag, nodes are ordered children first.
+// Leaves hold only the root vertex and so does the last node, which is the root of the decomposition.
+// Every edge except loops is introduced once, directly before the first of its ends is forgotten.
+typedef struct {
+	int nNodes;
+	int cap;
+	int rootVertex;
+	int width; // Of the bags with the root vertex
+	NiceNodeType *types;
+	int *items; // Introduced or forgotten vertex, introduced edge
+	int *children; // Pairs, -1 for no child
+} NiceTreeDecomposition;
+
+TreeDecomposition *createTreeDecomposition(int nBags, int nBagVertices, int nTreeEdges);
+
+void freeTreeDecomposition(TreeDecomposition *td);
+
+// Eliminates the vertex of approximately minimum degree until all are gone, NULL once a bag would exceed maxWidth + 1 vertices
+TreeDecomposition *minDegreeDecomposition(Graph *g, int maxWidth);
+
+// NULL if td is no tree decomposition of g
+NiceTreeDecomposition *createNiceTreeDecomposition(TreeDecomposition *td, int rootVertex, Graph *g);
+
+void freeNiceTreeDecomposition(NiceTreeDecomposition *ntd);
+
+#endif
@@ -7,6 +7,7 @@
 #include "test.h"
 #include "../structures/graph.h"
 #include "../structures/union-find.h"
+#include "../algorithms/heuristic/heuristic.h"
 
 bool scanMinCost(const char *filePath, double *minCost) {
 	// Extract instance file name from the path
@@ -136,3 +137,21 @@ bool isSteinerTree(SteinerTree st, Terminals *terms, Graph *g) {
 	freeUnionFind(uf);
 	return true;
 }
+
+bool matchesRecomputedTM(Graph *g, Terminals *terms) {
+	SteinerTree incremental = takahashiMatsuyama(g, terms);
+	SteinerTree recomputed = recomputingTakahashiMatsuyama(g, terms);
+
+	// Both add the same paths in the same order, so the edge lists are equal
+	bool isEqual = incremental.n == recomputed.n;
+	for (int i = 0; isEqual && i < incremental.n; i++) {
+		isEqual = incremental.treeEdgeIndices[i] == recomputed.treeEdgeIndices[i];
+	}
+	if (!isEqual) {
+		printf("Incremental Takahashi-Matsuyama differs from the recomputing one.\n");
+	}
+
+	free(incremental.treeEdgeIndices);
+	free(recomputed.treeEdgeIndices);
+	return isEqual;
+}
@@ -7,4 +7,7 @@ bool scanMinCost(const char *filePath, double *minCost);
 
 bool isSteinerTree(SteinerTree st, Terminals *terms, Graph *g);
 
+// Compares the tree of the incremental Takahashi-Matsuyama with the one of searches from the whole tree
+bool matchesRecomputedTM(Graph *g, Terminals *terms);
+
 #endif